@@ -0,0 +1,205 @@
+#include "Auto_tuner.h"
+#include "Newton_opt.h"
+#include "Random_search.h"
+#include "Run_control.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+Solver_profile::Solver_profile() : method(TUNED_NEWTON), step_ratio(0.1), beta(0.5), max_hessian_reuse(1), p(0.5), delta(1), alpha(1),
+    num_of_failures(-1), cost(0) {}
+
+Auto_tuner::Auto_tuner(Function_factory function_factory_, Area area_, std::vector<std::vector<double>> starts_, double target_f_, double eps_)
+    : function_factory(function_factory_), area(area_), starts(starts_), target_f(target_f_), eps(eps_), cost(COST_EVALUATIONS),
+    min_num_of_evaluations(1000), max_num_of_evaluations(27000), generator(0), num_of_probes(0) {
+    if (starts.empty())
+        throw std::invalid_argument("At least one start point is required.");
+    for (const std::vector<double>& x_0 : starts) {
+        if (!area.is_inside(x_0))
+            throw std::invalid_argument("Start point is outside the area.");
+    }
+}
+
+void Auto_tuner::set_cost(Tuning_cost cost_) {
+    cost = cost_;
+}
+
+void Auto_tuner::set_budget(long long min_num_of_evaluations_, long long max_num_of_evaluations_) {
+    if (min_num_of_evaluations_ <= 0 || max_num_of_evaluations_ < min_num_of_evaluations_)
+        throw std::invalid_argument("Evaluation limits must be positive and ordered.");
+    min_num_of_evaluations = min_num_of_evaluations_;
+    max_num_of_evaluations = max_num_of_evaluations_;
+}
+
+void Auto_tuner::set_seed(unsigned seed) {
+    generator.seed(seed);
+}
+
+long long Auto_tuner::get_num_of_probes() {
+    return num_of_probes;
+}
+
+Solver_profile Auto_tuner::sample() {
+    std::uniform_real_distribution<double> distribution(0, 1);
+    Solver_profile profile;
+    // Scale parameters are drawn uniformly in the logarithm, the others uniformly.
+    profile.method = distribution(generator) < 0.5 ? TUNED_NEWTON : TUNED_RANDOM_SEARCH;
+    profile.step_ratio = std::pow(10.0, -3 + 6 * distribution(generator));
+    profile.beta = 0.1 + 0.8 * distribution(generator);
+    profile.max_hessian_reuse = 1 + std::min(static_cast<int>(8 * distribution(generator)), 7);
+    profile.p = 0.05 + 0.9 * distribution(generator);
+    profile.delta = std::pow(10.0, -2 + 2 * distribution(generator));
+    profile.alpha = 0.5 + 0.5 * distribution(generator);
+    return profile;
+}
+
+void Auto_tuner::measure(Solver_profile& profile, long long max_num_of_evaluations_) {
+    profile.num_of_failures = 0;
+    profile.cost = 0;
+    for (const std::vector<double>& x_0 : starts) {
+        Function* function = function_factory();
+        // The criteria only end runs that get stuck; a probe ends at the target or at the evaluation limit.
+        Stop_criterion* stop_criterion = profile.method == TUNED_NEWTON
+            ? static_cast<Stop_criterion*>(new Criterion_grad_f(eps, INT_MAX))
+            : static_cast<Stop_criterion*>(new Criterion_max_iter(INT_MAX));
+        std::unique_ptr<Optimization_method> method(create_method(profile, function, x_0, area, stop_criterion));
+
+        Run_control control;
+        control.set_target_f(target_f);
+        control.set_max_num_of_evaluations(max_num_of_evaluations_);
+        control.start();
+        method->set_run_control(&control);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool is_reached;
+        try {
+            method->optimization();
+            is_reached = method->get_f() <= target_f;
+        }
+        catch (const std::exception&) {
+            is_reached = false;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!is_reached)
+            ++profile.num_of_failures;
+        profile.cost += cost == COST_WALL_TIME ? seconds : static_cast<double>(function->get_num_of_evaluations());
+        ++num_of_probes;
+    }
+}
+
+Solver_profile Auto_tuner::run(int num_of_candidates, int eta) {
+    if (num_of_candidates < 1 || eta < 2)
+        throw std::invalid_argument("Number of candidates must be positive and eta at least 2.");
+    num_of_probes = 0;
+
+    std::vector<Solver_profile> candidates(1);
+    while (static_cast<int>(candidates.size()) < num_of_candidates) {
+        candidates.push_back(sample());
+    }
+
+    long long limit = min_num_of_evaluations;
+    while (true) {
+        for (Solver_profile& candidate : candidates) {
+            measure(candidate, limit);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [](const Solver_profile& a, const Solver_profile& b) {
+            if (a.num_of_failures != b.num_of_failures)
+                return a.num_of_failures < b.num_of_failures;
+            return a.cost < b.cost;
+        });
+
+        if (candidates.size() == 1 || limit >= max_num_of_evaluations)
+            break;
+        candidates.resize(std::max<size_t>(candidates.size() / eta, 1));
+        limit = std::min(limit * eta, max_num_of_evaluations);
+    }
+    return candidates.front();
+}
+
+Optimization_method* Auto_tuner::create_method(const Solver_profile& profile, Function* function, std::vector<double> x_0, Area area,
+    Stop_criterion* stop_criterion) {
+    switch (profile.method) {
+    case TUNED_NEWTON: {
+        Newton_opt* method = new Newton_opt(function, x_0, area, stop_criterion);
+        method->set_step_ratio(profile.step_ratio);
+        method->set_backtracking(profile.beta);
+        method->set_hessian_reuse(profile.max_hessian_reuse);
+        return method;
+    }
+    case TUNED_RANDOM_SEARCH:
+        return new Random_search(function, x_0, area, stop_criterion, profile.p, profile.delta, profile.alpha);
+    default:
+        throw std::invalid_argument("Unknown method of the solver profile.");
+    }
+}
+
+void Auto_tuner::save_profile(const Solver_profile& profile, const std::string& path) {
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot open profile file " + path + ".");
+
+    out << std::setprecision(std::numeric_limits<double>::max_digits10)
+        << "newton_opt_profile 1\n"
+        << "method " << static_cast<int>(profile.method) << "\n"
+        << "step_ratio " << profile.step_ratio << "\n"
+        << "beta " << profile.beta << "\n"
+        << "max_hessian_reuse " << profile.max_hessian_reuse << "\n"
+        << "p " << profile.p << "\n"
+        << "delta " << profile.delta << "\n"
+        << "alpha " << profile.alpha << "\n"
+        << "num_of_failures " << profile.num_of_failures << "\n"
+        << "cost " << profile.cost << "\n";
+    if (!out)
+        throw std::runtime_error("Cannot write profile file " + path + ".");
+}
+
+Solver_profile Auto_tuner::load_profile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open profile file " + path + ".");
+
+    std::string key;
+    int version = 0;
+    if (!(in >> key >> version) || key != "newton_opt_profile" || version != 1)
+        throw std::runtime_error("File " + path + " is not a solver profile.");
+
+    Solver_profile profile;
+    int method = 0;
+    while (in >> key) {
+        bool is_read;
+        if (key == "method")
+            is_read = static_cast<bool>(in >> method);
+        else if (key == "step_ratio")
+            is_read = static_cast<bool>(in >> profile.step_ratio);
+        else if (key == "beta")
+            is_read = static_cast<bool>(in >> profile.beta);
+        else if (key == "max_hessian_reuse")
+            is_read = static_cast<bool>(in >> profile.max_hessian_reuse);
+        else if (key == "p")
+            is_read = static_cast<bool>(in >> profile.p);
+        else if (key == "delta")
+            is_read = static_cast<bool>(in >> profile.delta);
+        else if (key == "alpha")
+            is_read = static_cast<bool>(in >> profile.alpha);
+        else if (key == "num_of_failures")
+            is_read = static_cast<bool>(in >> profile.num_of_failures);
+        else if (key == "cost")
+            is_read = static_cast<bool>(in >> profile.cost);
+        else
+            throw std::runtime_error("Unknown key " + key + " in profile file " + path + ".");
+        if (!is_read)
+            throw std::runtime_error("Invalid value of " + key + " in profile file " + path + ".");
+    }
+
+    if (method != TUNED_NEWTON && method != TUNED_RANDOM_SEARCH)
+        throw std::runtime_error("Unknown method in profile file " + path + ".");
+    profile.method = static_cast<Tuned_method>(method);
+    return profile;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Optimization_method.h"
+#include "Stop_criterion.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <random>
+
+/**
+ * @brief Optimization method of a solver profile.
+ */
+enum Tuned_method {
+    TUNED_NEWTON = 1, /**< Newton's method with backtracking. */
+    TUNED_RANDOM_SEARCH = 2 /**< Random search. */
+};
+
+/**
+ * @brief Cost that the auto-tuner minimizes.
+ */
+enum Tuning_cost {
+    COST_EVALUATIONS = 0, /**< Number of function evaluations. */
+    COST_WALL_TIME = 1 /**< Wall-clock time. */
+};
+
+/**
+ * @brief Method and hyperparameters of a solver, chosen by hand or by Auto_tuner.
+ */
+struct Solver_profile {
+    Tuned_method method; /**< Optimization method. */
+    double step_ratio; /**< Finite-difference step as a fraction of eps, see Optimization_method::set_step_ratio. */
+    double beta; /**< Backtracking factor of Newton's method, see Newton_opt::set_backtracking. */
+    int max_hessian_reuse; /**< Maximum number of iterations using the same inverse Hessian matrix. */
+    double p; /**< Probability parameter of random search. */
+    double delta; /**< Initial radius of the neighborhood of random search. */
+    double alpha; /**< Coefficient diminishing the neighborhood of random search. */
+    int num_of_failures; /**< Number of probe solves that missed the target, -1 if the profile was not measured. */
+    double cost; /**< Total cost of the probe solves, in evaluations or seconds. */
+
+    /**
+     * @brief Default constructor. Newton's method with the settings the methods use by default.
+     */
+    Solver_profile();
+};
+
+/**
+ * @brief Class choosing the method and its hyperparameters for a class of problems by successive halving.
+ *
+ * The problem class is an objective function and an area with several start points. Every candidate
+ * configuration solves every probe problem with a limit on the number of evaluations, stopping when it
+ * reaches the target value. Candidates are ranked by the number of probes that missed the target, then by
+ * their total cost; after every round only the best 1 / eta of them go on, with eta times the limit.
+ * Most candidates are thus rejected after short probes, and the full limit is spent only on the best ones.
+ * The default configuration is always among the candidates, so the tuned profile is at least as good on
+ * the probes. The profile is saved to a text file and applied to later runs with create_method.
+ */
+class Auto_tuner {
+public:
+    typedef std::function<Function*()> Function_factory; /**< Creates a new objective function of the problem class. */
+
+private:
+    Function_factory function_factory; /**< Factory of the objective functions. */
+    Area area; /**< Area of the problems. */
+    std::vector<std::vector<double>> starts; /**< Start points of the probe problems. */
+    double target_f; /**< Function value a probe solve has to reach. */
+    double eps; /**< Tolerance of the stopping criterion of Newton's method. */
+    Tuning_cost cost; /**< Cost being minimized. */
+    long long min_num_of_evaluations; /**< Evaluation limit of a probe solve in the first round. */
+    long long max_num_of_evaluations; /**< Evaluation limit of a probe solve in the last round. */
+    std::mt19937 generator; /**< Generator of the candidate configurations. */
+    long long num_of_probes; /**< Number of probe solves made by run. */
+
+    /**
+     * @brief Draws a random configuration from the search space.
+     * @return Candidate configuration.
+     */
+    Solver_profile sample();
+
+    /**
+     * @brief Solves all probe problems with a configuration and records the number of failures and the cost in it.
+     * @param profile Configuration to measure.
+     * @param max_num_of_evaluations_ Evaluation limit of every probe solve.
+     */
+    void measure(Solver_profile& profile, long long max_num_of_evaluations_);
+
+public:
+    /**
+     * @brief Constructor for the auto-tuner.
+     * @param function_factory_ Function creating an objective of the problem class; the tuner deletes the objects.
+     * @param area_ Area of the problems.
+     * @param starts_ Start points of the probe problems, inside the area.
+     * @param target_f_ Function value a probe solve has to reach to count as a success.
+     * @param eps_ Tolerance of the gradient norm for Newton's method, also the base of its finite-difference step.
+     */
+    Auto_tuner(Function_factory function_factory_, Area area_, std::vector<std::vector<double>> starts_, double target_f_, double eps_);
+
+    /**
+     * @brief Sets the cost being minimized.
+     * @param cost_ Number of evaluations or wall-clock time.
+     */
+    void set_cost(Tuning_cost cost_);
+
+    /**
+     * @brief Sets the evaluation limits of the probe solves.
+     * @param min_num_of_evaluations_ Limit in the first round.
+     * @param max_num_of_evaluations_ Limit in the last round.
+     */
+    void set_budget(long long min_num_of_evaluations_, long long max_num_of_evaluations_);
+
+    /**
+     * @brief Sets the seed of the generator of the candidate configurations.
+     * @param seed Seed.
+     */
+    void set_seed(unsigned seed);
+
+    /**
+     * @brief Searches the configuration space.
+     * @param num_of_candidates Number of configurations in the first round, including the default one.
+     * @param eta Factor by which every round reduces the candidates and increases the limit, at least 2.
+     * @return Best configuration with its failures and cost in the last round it took part in.
+     */
+    Solver_profile run(int num_of_candidates = 27, int eta = 3);
+
+    /**
+     * @brief Getter for the number of probe solves made by the last run.
+     * @return Number of probe solves.
+     */
+    long long get_num_of_probes();
+
+    /**
+     * @brief Creates the optimization method of a profile.
+     * @param profile Solver profile.
+     * @param function Pointer to the objective function, owned by the method afterwards.
+     * @param x_0 Initial point.
+     * @param area Area constraint for optimization.
+     * @param stop_criterion Pointer to the stopping criterion, owned by the method afterwards.
+     * @return Pointer to the configured method.
+     */
+    static Optimization_method* create_method(const Solver_profile& profile, Function* function, std::vector<double> x_0, Area area,
+        Stop_criterion* stop_criterion);
+
+    /**
+     * @brief Writes a profile to a text file.
+     * @param profile Solver profile.
+     * @param path Path to the file.
+     */
+    static void save_profile(const Solver_profile& profile, const std::string& path);
+
+    /**
+     * @brief Reads a profile written by save_profile.
+     * @param path Path to the file.
+     * @return Solver profile.
+     */
+    static Solver_profile load_profile(const std::string& path);
+};
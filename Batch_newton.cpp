@@ -0,0 +1,426 @@
+#include "Batch_newton.h"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+Batch_function::Batch_function(const int dimension) : dim(dimension) {}
+
+Batch_function::~Batch_function() {}
+
+int Batch_function::get_dim() const {
+    return dim;
+}
+
+long long Batch_function::derivatives(const double* x, int stride, int n, double* g, double* h) const {
+    std::vector<double> shifted(static_cast<size_t>(dim) * n), f_0(n), f_plus(n), f_minus(n), f_pp(n), f_pm(n), f_mp(n), f_mm(n);
+    std::vector<double> step_g(static_cast<size_t>(dim) * n), step_h(static_cast<size_t>(dim) * n);
+    for (int i = 0; i < dim; ++i) {
+        for (int k = 0; k < n; ++k) {
+            double scale = std::max(std::fabs(x[i * stride + k]), 1.0);
+            step_g[i * n + k] = 1e-6 * scale;
+            step_h[i * n + k] = 1e-4 * scale;
+        }
+    }
+
+    long long num_of_evaluations = 0;
+    // Evaluates f at x + s_i * steps_i + s_j * steps_j for every point.
+    auto evaluate_shifted = [&](int i, double s_i, int j, double s_j, const std::vector<double>& steps, std::vector<double>& out) {
+        for (int l = 0; l < dim; ++l) {
+            for (int k = 0; k < n; ++k) {
+                shifted[l * n + k] = x[l * stride + k];
+            }
+        }
+        for (int k = 0; k < n; ++k) {
+            shifted[i * n + k] += s_i * steps[i * n + k];
+        }
+        if (j >= 0) {
+            for (int k = 0; k < n; ++k) {
+                shifted[j * n + k] += s_j * steps[j * n + k];
+            }
+        }
+        values(shifted.data(), n, n, out.data());
+        num_of_evaluations += n;
+    };
+
+    evaluate_shifted(0, 0, -1, 0, step_h, f_0);
+    for (int i = 0; i < dim; ++i) {
+        evaluate_shifted(i, 1, -1, 0, step_g, f_plus);
+        evaluate_shifted(i, -1, -1, 0, step_g, f_minus);
+        for (int k = 0; k < n; ++k) {
+            g[i * stride + k] = (f_plus[k] - f_minus[k]) / (2 * step_g[i * n + k]);
+        }
+
+        evaluate_shifted(i, 1, -1, 0, step_h, f_plus);
+        evaluate_shifted(i, -1, -1, 0, step_h, f_minus);
+        for (int k = 0; k < n; ++k) {
+            double s = step_h[i * n + k];
+            h[(i * dim + i) * stride + k] = (f_plus[k] - 2 * f_0[k] + f_minus[k]) / (s * s);
+        }
+
+        for (int j = 0; j < i; ++j) {
+            evaluate_shifted(i, 1, j, 1, step_h, f_pp);
+            evaluate_shifted(i, 1, j, -1, step_h, f_pm);
+            evaluate_shifted(i, -1, j, 1, step_h, f_mp);
+            evaluate_shifted(i, -1, j, -1, step_h, f_mm);
+            for (int k = 0; k < n; ++k) {
+                double value = (f_pp[k] - f_pm[k] - f_mp[k] + f_mm[k]) / (4 * step_h[i * n + k] * step_h[j * n + k]);
+                h[(i * dim + j) * stride + k] = value;
+                h[(j * dim + i) * stride + k] = value;
+            }
+        }
+    }
+    return num_of_evaluations;
+}
+
+
+Batch_function1::Batch_function1() : Batch_function(2) {}
+
+void Batch_function1::values(const double* x, int stride, int n, double* f) const {
+    const double* x1 = x;
+    const double* x2 = x + stride;
+    for (int k = 0; k < n; ++k) {
+        double a = x1[k] + 2 * x2[k] - 7, b = 2 * x1[k] + x2[k] - 5;
+        f[k] = a * a + b * b;
+    }
+}
+
+long long Batch_function1::derivatives(const double* x, int stride, int n, double* g, double* h) const {
+    const double* x1 = x;
+    const double* x2 = x + stride;
+    for (int k = 0; k < n; ++k) {
+        double a = x1[k] + 2 * x2[k] - 7, b = 2 * x1[k] + x2[k] - 5;
+        g[k] = 2 * a + 4 * b;
+        g[stride + k] = 4 * a + 2 * b;
+        h[k] = 10;
+        h[stride + k] = 8;
+        h[2 * stride + k] = 8;
+        h[3 * stride + k] = 10;
+    }
+    return 0;
+}
+
+
+Batch_function2::Batch_function2() : Batch_function(3) {}
+
+void Batch_function2::values(const double* x, int stride, int n, double* f) const {
+    const double* x1 = x;
+    const double* x2 = x + stride;
+    const double* x3 = x + 2 * stride;
+    for (int k = 0; k < n; ++k) {
+        f[k] = x1[k] * x1[k] + x2[k] * x2[k] + (1 - x3[k]) * (1 - x3[k]) + x1[k] * x2[k];
+    }
+}
+
+long long Batch_function2::derivatives(const double* x, int stride, int n, double* g, double* h) const {
+    const double* x1 = x;
+    const double* x2 = x + stride;
+    const double* x3 = x + 2 * stride;
+    const double hessian[9] = { 2, 1, 0, 1, 2, 0, 0, 0, 2 };
+    for (int k = 0; k < n; ++k) {
+        g[k] = 2 * x1[k] + x2[k];
+        g[stride + k] = 2 * x2[k] + x1[k];
+        g[2 * stride + k] = 2 * (x3[k] - 1);
+        for (int e = 0; e < 9; ++e) {
+            h[e * stride + k] = hessian[e];
+        }
+    }
+    return 0;
+}
+
+
+Batch_function3::Batch_function3(const int dimension) : Batch_function(dimension) {
+    if (dimension < 2 || dimension > 4)
+        throw std::invalid_argument("Batched Rosenbrock function dimension must be from 2 to 4.");
+}
+
+void Batch_function3::values(const double* x, int stride, int n, double* f) const {
+    for (int k = 0; k < n; ++k) {
+        f[k] = 0;
+    }
+    for (int i = 0; i < dim - 1; ++i) {
+        const double* xi = x + i * stride;
+        const double* xn = x + (i + 1) * stride;
+        for (int k = 0; k < n; ++k) {
+            double t = xn[k] - xi[k] * xi[k];
+            f[k] += 100 * t * t + (xi[k] - 1) * (xi[k] - 1);
+        }
+    }
+}
+
+long long Batch_function3::derivatives(const double* x, int stride, int n, double* g, double* h) const {
+    for (int e = 0; e < dim * dim; ++e) {
+        std::fill(h + e * stride, h + e * stride + n, 0.0);
+    }
+    std::fill(g, g + n, 0.0);
+    for (int i = 0; i < dim - 1; ++i) {
+        const double* xi = x + i * stride;
+        const double* xn = x + (i + 1) * stride;
+        double* gi = g + i * stride;
+        double* gn = g + (i + 1) * stride;
+        double* h_ii = h + (i * dim + i) * stride;
+        double* h_in = h + (i * dim + i + 1) * stride;
+        double* h_ni = h + ((i + 1) * dim + i) * stride;
+        double* h_nn = h + ((i + 1) * dim + i + 1) * stride;
+        for (int k = 0; k < n; ++k) {
+            double t = xn[k] - xi[k] * xi[k];
+            gi[k] += -400 * xi[k] * t + 2 * (xi[k] - 1);
+            gn[k] = 200 * t;
+            h_ii[k] += 1200 * xi[k] * xi[k] - 400 * xn[k] + 2;
+            h_in[k] = -400 * xi[k];
+            h_ni[k] = -400 * xi[k];
+            h_nn[k] = 200;
+        }
+    }
+    return 0;
+}
+
+
+Batch_newton::Batch_newton(Batch_function* function_, double eps_, int max_num_of_iterations_, int batch_size_)
+    : function(function_), eps(eps_), max_num_of_iterations(max_num_of_iterations_), batch_size(batch_size_),
+    num_of_evaluations(0) {
+    if (function->get_dim() < 1 || function->get_dim() > 4)
+        throw std::invalid_argument("Batched Newton's method supports dimensions 1 to 4.");
+    if (batch_size <= 0)
+        throw std::invalid_argument("Batch size must be positive.");
+}
+
+Batch_newton::~Batch_newton() {
+    delete function;
+}
+
+int Batch_newton::add_problem(const std::vector<double>& x_0, Area area) {
+    if (static_cast<int>(x_0.size()) != function->get_dim() || static_cast<int>(area.get_box().size()) != function->get_dim())
+        throw std::invalid_argument("Problem dimension does not match the function.");
+    starts.push_back(x_0);
+    boxes.push_back(area.get_box());
+    return static_cast<int>(starts.size()) - 1;
+}
+
+int Batch_newton::get_num_of_problems() {
+    return static_cast<int>(starts.size());
+}
+
+long long Batch_newton::get_num_of_evaluations() {
+    return num_of_evaluations;
+}
+
+std::vector<Batch_result> Batch_newton::solve() {
+    switch (function->get_dim()) {
+    case 1:
+        return solve_fixed<1>();
+    case 2:
+        return solve_fixed<2>();
+    case 3:
+        return solve_fixed<3>();
+    default:
+        return solve_fixed<4>();
+    }
+}
+
+template <int D>
+std::vector<Batch_result> Batch_newton::solve_fixed() {
+    const int B = batch_size;
+    const int num_of_problems = static_cast<int>(starts.size());
+    // Below this step length the trial point equals the current one up to rounding.
+    const double alpha_min = 1e-16;
+
+    std::vector<double> x(D * B), lo(D * B), hi(D * B), g(D * B), h(D * D * B), p(D * B), x_trial(D * B);
+    std::vector<double> a(D * D * B), b(D * B), slope(B);
+    std::vector<double> f(B), f_trial(B), alpha(B);
+    std::vector<int> iter(B), id(B);
+    std::vector<char> is_done(B), is_converged(B), is_stalled(B);
+    std::vector<int> searching;
+    std::vector<Batch_result> results(num_of_problems);
+
+    // Moves lane `from` to lane `to`.
+    auto move_lane = [&](int from, int to) {
+        for (int i = 0; i < D; ++i) {
+            x[i * B + to] = x[i * B + from];
+            lo[i * B + to] = lo[i * B + from];
+            hi[i * B + to] = hi[i * B + from];
+        }
+        f[to] = f[from];
+        iter[to] = iter[from];
+        id[to] = id[from];
+        is_stalled[to] = is_stalled[from];
+    };
+
+    int n = 0, next = 0;
+    while (true) {
+        // Fills the free lanes with the next problems.
+        int first_new = n;
+        for (; n < B && next < num_of_problems; ++n, ++next) {
+            for (int i = 0; i < D; ++i) {
+                x[i * B + n] = starts[next][i];
+                lo[i * B + n] = boxes[next][i].first;
+                hi[i * B + n] = boxes[next][i].second;
+            }
+            iter[n] = 0;
+            id[n] = next;
+            is_stalled[n] = 0;
+        }
+        if (n == 0)
+            break;
+        if (first_new < n) {
+            std::vector<double> x_new(D * (n - first_new));
+            for (int i = 0; i < D; ++i) {
+                std::copy(&x[i * B + first_new], &x[i * B + n], &x_new[i * (n - first_new)]);
+            }
+            function->values(x_new.data(), n - first_new, n - first_new, &f[first_new]);
+            num_of_evaluations += n - first_new;
+        }
+
+        num_of_evaluations += function->derivatives(x.data(), B, n, g.data(), h.data());
+
+        int num_of_done = 0;
+        for (int k = 0; k < n; ++k) {
+            double norm_sq = 0;
+            for (int i = 0; i < D; ++i) {
+                norm_sq += g[i * B + k] * g[i * B + k];
+            }
+            is_converged[k] = std::sqrt(norm_sq) < eps;
+            is_done[k] = is_converged[k] || is_stalled[k] || iter[k] >= max_num_of_iterations;
+            num_of_done += is_done[k];
+        }
+
+        // Finished lanes stay masked until enough of them have gathered to be worth a compaction.
+        if (num_of_done > 0 && (4 * num_of_done >= n || num_of_done == n)) {
+            for (int k = n - 1; k >= 0; --k) {
+                if (!is_done[k])
+                    continue;
+
+                Batch_result& result = results[id[k]];
+                result.x.resize(D);
+                for (int i = 0; i < D; ++i) {
+                    result.x[i] = x[i * B + k];
+                }
+                result.f = f[k];
+                result.num_of_iter = iter[k];
+                result.is_converged = is_converged[k] != 0;
+
+                --n;
+                if (k != n) {
+                    move_lane(n, k);
+                    for (int i = 0; i < D; ++i) {
+                        g[i * B + k] = g[i * B + n];
+                    }
+                    for (int e = 0; e < D * D; ++e) {
+                        h[e * B + k] = h[e * B + n];
+                    }
+                    is_done[k] = is_done[n];
+                    is_converged[k] = is_converged[n];
+                }
+            }
+            if (n == 0)
+                continue;
+        }
+
+        // Newton direction from H p = -g by Gaussian elimination with partial pivoting. The system of lane k
+        // is stored structure-of-arrays like h, a[e * B + k], so every step below is one loop over the lanes;
+        // the row exchanges are selects rather than branches.
+        for (int e = 0; e < D * D; ++e) {
+            for (int k = 0; k < n; ++k) {
+                a[e * B + k] = h[e * B + k];
+            }
+        }
+        for (int i = 0; i < D; ++i) {
+            for (int k = 0; k < n; ++k) {
+                b[i * B + k] = -g[i * B + k];
+            }
+        }
+        for (int c = 0; c < D; ++c) {
+            // Brings the entry of the largest magnitude in column c to row c.
+            for (int r = c + 1; r < D; ++r) {
+                for (int k = 0; k < n; ++k) {
+                    bool is_larger = std::fabs(a[(r * D + c) * B + k]) > std::fabs(a[(c * D + c) * B + k]);
+                    for (int j = c; j < D; ++j) {
+                        double upper = a[(c * D + j) * B + k], lower = a[(r * D + j) * B + k];
+                        a[(c * D + j) * B + k] = is_larger ? lower : upper;
+                        a[(r * D + j) * B + k] = is_larger ? upper : lower;
+                    }
+                    double upper = b[c * B + k], lower = b[r * B + k];
+                    b[c * B + k] = is_larger ? lower : upper;
+                    b[r * B + k] = is_larger ? upper : lower;
+                }
+            }
+            for (int r = c + 1; r < D; ++r) {
+                for (int k = 0; k < n; ++k) {
+                    double m = a[(r * D + c) * B + k] / a[(c * D + c) * B + k];
+                    for (int j = c + 1; j < D; ++j) {
+                        a[(r * D + j) * B + k] -= m * a[(c * D + j) * B + k];
+                    }
+                    b[r * B + k] -= m * b[c * B + k];
+                }
+            }
+        }
+        for (int k = 0; k < n; ++k) {
+            slope[k] = 0;
+        }
+        for (int r = D - 1; r >= 0; --r) {
+            for (int k = 0; k < n; ++k) {
+                double value = b[r * B + k];
+                for (int j = r + 1; j < D; ++j) {
+                    value -= a[(r * D + j) * B + k] * b[j * B + k];
+                }
+                b[r * B + k] = value / a[(r * D + r) * B + k];
+                slope[k] += b[r * B + k] * g[r * B + k];
+            }
+        }
+        // A singular system or an ascent direction is replaced by the steepest descent direction.
+        for (int k = 0; k < n; ++k) {
+            bool is_newton = slope[k] - slope[k] == 0 && slope[k] < 0;
+            for (int i = 0; i < D; ++i) {
+                p[i * B + k] = is_done[k] ? 0.0 : (is_newton ? b[i * B + k] : -g[i * B + k]);
+            }
+            alpha[k] = 1;
+        }
+
+        // Backtracking line search in lockstep. The lanes still searching are gathered at the front of
+        // the trial buffer, so a round evaluates only them.
+        searching.clear();
+        for (int k = 0; k < n; ++k) {
+            if (!is_done[k])
+                searching.push_back(k);
+        }
+        while (!searching.empty()) {
+            int m = static_cast<int>(searching.size());
+            for (int i = 0; i < D; ++i) {
+                for (int l = 0; l < m; ++l) {
+                    int k = searching[l];
+                    x_trial[i * B + l] = x[i * B + k] + alpha[k] * p[i * B + k];
+                }
+            }
+            function->values(x_trial.data(), B, m, f_trial.data());
+            num_of_evaluations += m;
+
+            int num_of_searching = 0;
+            for (int l = 0; l < m; ++l) {
+                int k = searching[l];
+                bool is_inside = true;
+                for (int i = 0; i < D; ++i) {
+                    double value = x_trial[i * B + l];
+                    is_inside = is_inside && value >= lo[i * B + k] && value <= hi[i * B + k];
+                }
+
+                if (f_trial[l] <= f[k] && is_inside) {
+                    for (int i = 0; i < D; ++i) {
+                        x[i * B + k] = x_trial[i * B + l];
+                    }
+                    f[k] = f_trial[l];
+                    ++iter[k];
+                }
+                else if (alpha[k] < alpha_min) {
+                    // No step is possible: the lane is retired at the next check.
+                    is_stalled[k] = 1;
+                }
+                else {
+                    alpha[k] *= 0.5;
+                    searching[num_of_searching++] = k;
+                }
+            }
+            searching.resize(num_of_searching);
+        }
+    }
+
+    return results;
+}
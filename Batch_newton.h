@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Area.h"
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief Base class representing a function evaluated for many points at once.
+ *
+ * Points are stored structure-of-arrays: coordinate i of point k is x[i * stride + k], so a loop
+ * over k runs over contiguous memory and is vectorized by the compiler.
+ */
+class Batch_function {
+protected:
+    int dim; /**< Dimension of the function. */
+
+public:
+    /**
+     * @brief Constructor initializing the function with a specified dimension.
+     * @param dimension Dimension of the function.
+     */
+    explicit Batch_function(const int dimension);
+
+    /**
+     * @brief Virtual destructor for proper polymorphic behavior.
+     */
+    virtual ~Batch_function();
+
+    /**
+     * @brief Getter for the dimension of the function.
+     * @return Dimension of the function.
+     */
+    int get_dim() const;
+
+    /**
+     * @brief Pure virtual function calculating the function values of n points.
+     * @param x Coordinates, x[i * stride + k] is coordinate i of point k.
+     * @param stride Distance between the coordinates of a point.
+     * @param n Number of points.
+     * @param f Array of n values receiving the function values.
+     */
+    virtual void values(const double* x, int stride, int n, double* f) const = 0;
+
+    /**
+     * @brief Calculates the gradients and the Hessian matrices of n points.
+     * The default implementation uses central differences with steps relative to max(|x_i|, 1).
+     * @param x Coordinates, x[i * stride + k] is coordinate i of point k.
+     * @param stride Distance between the coordinates of a point.
+     * @param n Number of points.
+     * @param g Gradients, g[i * stride + k].
+     * @param h Hessian matrices, h[(i * dim + j) * stride + k].
+     * @return Number of lane evaluations of values() spent on the derivatives, 0 if they are analytic.
+     */
+    virtual long long derivatives(const double* x, int stride, int n, double* g, double* h) const;
+};
+
+/**
+ * @brief Batched Booth function, see Function1.
+ */
+class Batch_function1 : public Batch_function {
+public:
+    /**
+     * @brief Default constructor initializing the function with dimension 2.
+     */
+    Batch_function1();
+
+    void values(const double* x, int stride, int n, double* f) const override;
+    long long derivatives(const double* x, int stride, int n, double* g, double* h) const override;
+};
+
+/**
+ * @brief Batched function x_1^2 + x_2^2 + (1 - x_3)^2 + x_1 * x_2, see Function2.
+ */
+class Batch_function2 : public Batch_function {
+public:
+    /**
+     * @brief Default constructor initializing the function with dimension 3.
+     */
+    Batch_function2();
+
+    void values(const double* x, int stride, int n, double* f) const override;
+    long long derivatives(const double* x, int stride, int n, double* g, double* h) const override;
+};
+
+/**
+ * @brief Batched Rosenbrock function, see Function3.
+ */
+class Batch_function3 : public Batch_function {
+public:
+    /**
+     * @brief Constructor for the Rosenbrock function.
+     * @param dimension Dimension of the function, 2 to 4.
+     */
+    explicit Batch_function3(const int dimension = 4);
+
+    void values(const double* x, int stride, int n, double* f) const override;
+    long long derivatives(const double* x, int stride, int n, double* g, double* h) const override;
+};
+
+/**
+ * @brief Result of one problem solved by the batched Newton's method.
+ */
+struct Batch_result {
+    std::vector<double> x; /**< Last point. */
+    double f; /**< Function value at the last point. */
+    int num_of_iter; /**< Number of Newton steps. */
+    bool is_converged; /**< True if the norm of the gradient fell below eps. */
+};
+
+/**
+ * @brief Newton's method solving many small independent problems in lockstep.
+ *
+ * The problems share the objective and differ in the start point and the area. A batch of problems
+ * is stored structure-of-arrays, one lane per problem, and every stage of a step - derivatives,
+ * the solution of the dim x dim system and the backtracking line search - runs over all lanes in one
+ * vectorizable loop. Finished lanes are masked out and periodically replaced by the next problems,
+ * so the lanes stay full. The steps follow Newton_opt with Criterion_grad_f; the Newton system is
+ * solved by Gaussian elimination with partial pivoting, and if it is singular or gives an ascent
+ * direction, the lane takes a gradient step instead. A lane whose line search finds no step stops
+ * unconverged. Supports dimensions 1 to 4.
+ */
+class Batch_newton {
+private:
+    Batch_function* function; /**< Objective function, owned by the solver. */
+    double eps; /**< Tolerance of the gradient norm. */
+    int max_num_of_iterations; /**< Maximum number of Newton steps of a problem. */
+    int batch_size; /**< Number of lanes. */
+    long long num_of_evaluations; /**< Number of lane evaluations of the function values, including finite differences. */
+    std::vector<std::vector<double>> starts; /**< Start point of every problem. */
+    std::vector<std::vector<std::pair<double, double>>> boxes; /**< Bounding box of every problem. */
+
+    /**
+     * @brief Solves all problems for a fixed dimension.
+     * @return Result of every problem.
+     */
+    template <int D>
+    std::vector<Batch_result> solve_fixed();
+
+public:
+    /**
+     * @brief Constructor for the batched Newton's method.
+     * @param function_ Pointer to the objective function, owned by the solver afterwards.
+     * @param eps_ Tolerance of the gradient norm.
+     * @param max_num_of_iterations_ Maximum number of Newton steps of a problem.
+     * @param batch_size_ Number of problems solved in lockstep.
+     */
+    Batch_newton(Batch_function* function_, double eps_, int max_num_of_iterations_ = 100, int batch_size_ = 256);
+
+    /**
+     * @brief Destructor. Deletes the function.
+     */
+    ~Batch_newton();
+
+    Batch_newton(const Batch_newton&) = delete;
+    Batch_newton& operator=(const Batch_newton&) = delete;
+
+    /**
+     * @brief Adds a problem.
+     * @param x_0 Start point.
+     * @param area Area constraint of the problem.
+     * @return Index of the problem.
+     */
+    int add_problem(const std::vector<double>& x_0, Area area);
+
+    /**
+     * @brief Getter for the number of problems.
+     * @return Number of problems.
+     */
+    int get_num_of_problems();
+
+    /**
+     * @brief Getter for the number of function evaluations, counted per lane.
+     * @return Number of evaluations.
+     */
+    long long get_num_of_evaluations();
+
+    /**
+     * @brief Solves all problems.
+     * @return Result of every problem in the order they were added.
+     */
+    std::vector<Batch_result> solve();
+};
@@ -0,0 +1,238 @@
+#include "Branch_and_bound.h"
+#include "Newton_opt.h"
+#include "Stop_criterion.h"
+#include "Run_control.h"
+#include "Thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    /**
+     * @brief Queue of boxes of one thread. The owner works at the back, thieves take from the front.
+     */
+    struct Box_queue {
+        std::mutex mutex;
+        std::deque<std::vector<Interval>> boxes;
+    };
+}
+
+Branch_and_bound::Branch_and_bound(Function* function_, Area area_, double eps_, int num_of_threads_)
+    : function(function_), area(area_), eps(eps_), num_of_threads(num_of_threads_), min_width(1e-9), max_num_of_local_runs(16) {
+    if (!function->has_interval_extension())
+        throw std::invalid_argument("Branch and bound requires a function with an interval extension.");
+    if (area.get_box().size() != static_cast<size_t>(function->get_dim()))
+        throw std::invalid_argument("Branch and bound requires a bounded area of the function dimension.");
+    if (eps < 0)
+        throw std::invalid_argument("Tolerance must be non-negative.");
+}
+
+Branch_and_bound::~Branch_and_bound() {
+    delete function;
+}
+
+void Branch_and_bound::set_min_width(double min_width_) {
+    min_width = min_width_;
+}
+
+void Branch_and_bound::set_max_local_runs(int max_num_of_local_runs_) {
+    max_num_of_local_runs = max_num_of_local_runs_;
+}
+
+Branch_and_bound_result Branch_and_bound::run() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int dim = function->get_dim();
+    std::vector<std::pair<double, double>> box = area.get_box();
+
+    // Every thread needs its own copy of the function; one that cannot be copied is searched on one thread.
+    std::unique_ptr<Function> probe(function->clone());
+    Thread_pool pool(probe ? num_of_threads : 1);
+    int threads = pool.get_num_of_threads();
+    std::vector<std::unique_ptr<Function>> clones(threads);
+    for (int t = 0; t < threads; ++t) {
+        if (probe)
+            clones[t].reset(function->clone());
+    }
+    auto function_of = [&](int thread) {
+        return clones[thread] ? clones[thread].get() : function;
+    };
+
+    bool has_gradient = function->has_interval_gradient();
+    Incumbent incumbent;
+    std::atomic<int> num_of_local_runs(0);
+    // Local runs need a copy the method can own, so they are skipped for functions without clone().
+    auto local_run = [&](const std::vector<double>& x_0, int thread) {
+        if (!probe || num_of_local_runs.fetch_add(1) >= max_num_of_local_runs)
+            return;
+        try {
+            Newton_opt method(function->clone(), x_0, area, new Criterion_grad_f(1e-6, 100));
+            method.optimization();
+            incumbent.update(method.get_x(), method.get_f(), thread);
+        }
+        catch (const std::exception&) {
+        }
+    };
+
+    std::vector<Interval> root(dim);
+    std::vector<double> center(dim);
+    for (int i = 0; i < dim; ++i) {
+        root[i] = Interval(box[i].first, box[i].second);
+        center[i] = root[i].midpoint();
+    }
+    incumbent.update(center, function_of(0)->calculate(center), 0);
+    local_run(center, 0);
+
+    std::vector<std::unique_ptr<Box_queue>> queues(threads);
+    for (int t = 0; t < threads; ++t) {
+        queues[t].reset(new Box_queue());
+    }
+    queues[0]->boxes.push_back(root);
+
+    // Boxes in the queues or being processed; the search is over when none are left.
+    std::atomic<long long> num_of_pending(1);
+    std::atomic<bool> is_failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<long long> num_of_boxes(threads, 0), num_of_pruned(threads, 0), num_of_steals(threads, 0);
+    std::vector<double> leaf_lower_bound(threads, std::numeric_limits<double>::infinity());
+
+    pool.parallel_for(threads, [&](int, int, int thread) {
+        Function* f = function_of(thread);
+        std::vector<Interval> current, gradient, point_box(dim);
+        std::vector<double> midpoint(dim);
+        try {
+            while (num_of_pending.load() > 0 && !is_failed.load()) {
+                bool is_taken = false;
+                {
+                    std::lock_guard<std::mutex> lock(queues[thread]->mutex);
+                    if (!queues[thread]->boxes.empty()) {
+                        current = std::move(queues[thread]->boxes.back());
+                        queues[thread]->boxes.pop_back();
+                        is_taken = true;
+                    }
+                }
+                for (int k = 1; k < threads && !is_taken; ++k) {
+                    Box_queue& victim = *queues[(thread + k) % threads];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.boxes.empty()) {
+                        current = std::move(victim.boxes.front());
+                        victim.boxes.pop_front();
+                        is_taken = true;
+                        ++num_of_steals[thread];
+                    }
+                }
+                if (!is_taken) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ++num_of_boxes[thread];
+                int widest = 0;
+                for (int i = 0; i < dim; ++i) {
+                    midpoint[i] = current[i].midpoint();
+                    if (current[i].width() > current[widest].width())
+                        widest = i;
+                }
+
+                double lower;
+                bool is_reduced = false, is_dominated = false;
+                if (has_gradient) {
+                    Interval value = f->calculate_interval_gradient(current, gradient);
+                    // Mean value form f(m) + sum g_i * (x_i - m_i): its overestimation shrinks with the square of the width.
+                    for (int i = 0; i < dim; ++i) {
+                        point_box[i] = midpoint[i];
+                    }
+                    Interval mean_value = f->calculate_interval(point_box);
+                    for (int i = 0; i < dim; ++i) {
+                        mean_value += gradient[i] * (current[i] - midpoint[i]);
+                    }
+                    double value_lower = value.get_lower(), mean_value_lower = mean_value.get_lower();
+                    lower = std::isnan(value_lower) || std::isnan(mean_value_lower) ? -INFINITY : std::max(value_lower, mean_value_lower);
+
+                    // Monotonicity test: a function monotone in x_i takes its minimum over the box on one face, which
+                    // is dominated by the neighboring box unless it lies on the border of the area.
+                    for (int i = 0; i < dim && !is_dominated; ++i) {
+                        // Written so that a NaN bound of the derivative does not count as a sign.
+                        if (current[i].width() == 0 || !(gradient[i].get_lower() > 0 || gradient[i].get_upper() < 0))
+                            continue;
+                        double face = gradient[i].get_lower() > 0 ? current[i].get_lower() : current[i].get_upper();
+                        if (face != box[i].first && face != box[i].second)
+                            is_dominated = true;
+                        current[i] = Interval(face, face);
+                        is_reduced = true;
+                    }
+                }
+                else {
+                    lower = f->calculate_interval(current).get_lower();
+                }
+                // A bound that is NaN or infinite, e.g. from log or sqrt outside their domain, says nothing about the box.
+                if (!std::isfinite(lower))
+                    lower = -INFINITY;
+
+                if (is_dominated || lower >= incumbent.get_f() - eps) {
+                    ++num_of_pruned[thread];
+                    if (!is_dominated)
+                        leaf_lower_bound[thread] = std::min(leaf_lower_bound[thread], lower);
+                    --num_of_pending;
+                    continue;
+                }
+                if (is_reduced) {
+                    std::lock_guard<std::mutex> lock(queues[thread]->mutex);
+                    queues[thread]->boxes.push_back(std::move(current));
+                    continue;
+                }
+                double value = f->calculate(midpoint);
+                if (incumbent.update(midpoint, value, thread))
+                    local_run(midpoint, thread);
+
+                if (current[widest].width() < min_width) {
+                    leaf_lower_bound[thread] = std::min(leaf_lower_bound[thread], lower);
+                    --num_of_pending;
+                    continue;
+                }
+
+                std::vector<Interval> other = current;
+                current[widest] = Interval(current[widest].get_lower(), midpoint[widest]);
+                other[widest] = Interval(midpoint[widest], other[widest].get_upper());
+                ++num_of_pending;
+                std::lock_guard<std::mutex> lock(queues[thread]->mutex);
+                queues[thread]->boxes.push_back(std::move(other));
+                queues[thread]->boxes.push_back(std::move(current));
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+            is_failed = true;
+        }
+    });
+    if (error)
+        std::rethrow_exception(error);
+
+    Branch_and_bound_result result;
+    result.x = incumbent.get_x();
+    result.f = incumbent.get_f();
+    result.lower_bound = result.f;
+    result.num_of_boxes = 0;
+    result.num_of_pruned = 0;
+    result.num_of_steals = 0;
+    for (int t = 0; t < threads; ++t) {
+        result.lower_bound = std::min(result.lower_bound, leaf_lower_bound[t]);
+        result.num_of_boxes += num_of_boxes[t];
+        result.num_of_pruned += num_of_pruned[t];
+        result.num_of_steals += num_of_steals[t];
+    }
+    result.is_certified = result.f - result.lower_bound <= eps;
+    result.num_of_local_runs = std::min(num_of_local_runs.load(), max_num_of_local_runs);
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
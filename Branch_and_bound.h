@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Interval.h"
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief Result of a branch-and-bound run.
+ */
+struct Branch_and_bound_result {
+    std::vector<double> x; /**< Best point found. */
+    double f; /**< Function value at the best point, an upper bound of the global minimum. */
+    double lower_bound; /**< Certified lower bound of the global minimum over the area. */
+    bool is_certified; /**< True if f - lower_bound <= eps, i.e. f is the global minimum up to eps. */
+    long long num_of_boxes; /**< Number of processed boxes. */
+    long long num_of_pruned; /**< Number of boxes discarded by their lower bound. */
+    long long num_of_steals; /**< Number of boxes taken from the queue of another thread. */
+    int num_of_local_runs; /**< Number of local Newton_opt runs. */
+    double elapsed_seconds; /**< Wall-clock time of the run. */
+};
+
+/**
+ * @brief Interval branch-and-bound method finding the global minimum over the area with a certificate.
+ *
+ * Boxes are taken from a queue, the interval extension of the function gives a lower bound of the
+ * function over the box, and the box is discarded if the bound is within eps of the incumbent, the best
+ * value found so far. Otherwise the function is evaluated at the midpoint, which may improve the
+ * incumbent, and the box is bisected along its widest side. When the midpoint improves the incumbent,
+ * a local Newton_opt run from it usually brings the incumbent to the global minimum early, so that
+ * most of the area is pruned. Boxes narrower than min_width are not bisected further; their lower
+ * bounds go into the certified bound.
+ *
+ * Every thread has its own queue and processes its newest box first, which keeps the queues small;
+ * an idle thread steals the oldest, and so the largest, box from another thread. The incumbent is
+ * shared, so a value found by one thread prunes the boxes of all of them.
+ */
+class Branch_and_bound {
+private:
+    Function* function; /**< Pointer to the objective function, with an interval extension. */
+    Area area; /**< Bounded area of the search. */
+    double eps; /**< Absolute tolerance of the global minimum. */
+    int num_of_threads; /**< Number of threads, 0 for the number of hardware threads. */
+    double min_width; /**< Width below which boxes are not bisected. */
+    int max_num_of_local_runs; /**< Maximum number of local Newton_opt runs. */
+
+public:
+    /**
+     * @brief Constructor for the branch-and-bound method.
+     * @param function_ Pointer to the objective function with an interval extension, owned by the method afterwards.
+     * @param area_ Bounded area of the search.
+     * @param eps_ Absolute tolerance of the global minimum.
+     * @param num_of_threads_ Number of threads, 0 for the number of hardware threads. Requires clone() for more than one.
+     */
+    Branch_and_bound(Function* function_, Area area_, double eps_, int num_of_threads_ = 0);
+
+    /**
+     * @brief Destructor. Deletes the function.
+     */
+    ~Branch_and_bound();
+
+    Branch_and_bound(const Branch_and_bound&) = delete;
+    Branch_and_bound& operator=(const Branch_and_bound&) = delete;
+
+    /**
+     * @brief Sets the width below which boxes are not bisected.
+     * @param min_width_ Width of the widest side, 1e-9 by default.
+     */
+    void set_min_width(double min_width_);
+
+    /**
+     * @brief Sets the maximum number of local Newton_opt runs.
+     * @param max_num_of_local_runs_ Maximum number of runs, 0 disables them.
+     */
+    void set_max_local_runs(int max_num_of_local_runs_);
+
+    /**
+     * @brief Searches the area.
+     * @return Best point, certified lower bound and statistics.
+     */
+    Branch_and_bound_result run();
+};
@@ -0,0 +1,147 @@
+#include "Checkpoint.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+Checkpoint::Checkpoint() : interval(0), next_iter(0) {}
+
+Checkpoint::Checkpoint(const std::string& path_, int interval_) : path(path_), interval(interval_), next_iter(interval_) {}
+
+Checkpoint::~Checkpoint() {
+    try {
+        wait();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+bool Checkpoint::is_enabled() const {
+    return !path.empty() && interval > 0;
+}
+
+const std::string& Checkpoint::get_path() const {
+    return path;
+}
+
+bool Checkpoint::is_due(int num_of_iter) {
+    if (!is_enabled() || num_of_iter < next_iter)
+        return false;
+
+    // The previous write is still running: postpone the checkpoint instead of waiting for it.
+    if (pending_write.valid() &&
+        pending_write.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+    return true;
+}
+
+void Checkpoint::write_async(std::string data, std::string history, uint64_t history_offset, int num_of_iter) {
+    wait();
+    next_iter = num_of_iter + interval;
+    pending_write = std::async(std::launch::async, &Checkpoint::write_files, path, std::move(data), std::move(history), history_offset);
+}
+
+void Checkpoint::write(std::string data, std::string history, uint64_t history_offset) {
+    wait();
+    write_files(path, data, history, history_offset);
+}
+
+void Checkpoint::wait() {
+    if (pending_write.valid())
+        pending_write.get();
+}
+
+void Checkpoint::write_files(const std::string& path_, const std::string& data, const std::string& history, uint64_t history_offset) {
+    if (!history.empty()) {
+        std::string history_path_ = history_path(path_);
+        std::FILE* file = std::fopen(history_path_.c_str(), "r+b");
+        if (file == nullptr)
+            file = std::fopen(history_path_.c_str(), "wb");
+        if (file == nullptr)
+            throw std::runtime_error("Cannot open history file " + history_path_ + ".");
+        // The history has to be on disk before the state that refers to it.
+#ifdef _WIN32
+        bool is_written = _fseeki64(file, static_cast<__int64>(history_offset), SEEK_SET) == 0;
+#else
+        bool is_written = fseeko(file, static_cast<off_t>(history_offset), SEEK_SET) == 0;
+#endif
+        is_written = is_written && std::fwrite(history.data(), 1, history.size(), file) == history.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+        is_written = is_written && _commit(_fileno(file)) == 0;
+#else
+        is_written = is_written && fsync(fileno(file)) == 0;
+#endif
+        is_written = std::fclose(file) == 0 && is_written;
+        if (!is_written)
+            throw std::runtime_error("Cannot write history file " + history_path_ + ".");
+    }
+    write_file(path_, data);
+}
+
+void Checkpoint::write_file(const std::string& path_, const std::string& data) {
+    std::string tmp_path = path_ + ".tmp";
+    std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr)
+        throw std::runtime_error("Cannot open checkpoint file " + tmp_path + ".");
+    // The data must reach the disk before the rename, or a crash could leave the new name on an empty file.
+    bool is_written = std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+    is_written = is_written && _commit(_fileno(file)) == 0;
+#else
+    is_written = is_written && fsync(fileno(file)) == 0;
+#endif
+    is_written = std::fclose(file) == 0 && is_written;
+    if (!is_written)
+        throw std::runtime_error("Cannot write checkpoint file " + tmp_path + ".");
+
+#ifdef _WIN32
+    if (!MoveFileExA(tmp_path.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        throw std::runtime_error("Cannot replace checkpoint file " + path_ + ".");
+#else
+    if (std::rename(tmp_path.c_str(), path_.c_str()) != 0)
+        throw std::runtime_error("Cannot replace checkpoint file " + path_ + ".");
+
+    // The rename itself is durable only once the directory is synced.
+    size_t slash = path_.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path_.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#endif
+}
+
+std::string Checkpoint::read_file(const std::string& path_) {
+    std::ifstream in(path_, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open checkpoint file " + path_ + ".");
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+std::string Checkpoint::history_path(const std::string& path_) {
+    return path_ + ".history";
+}
+
+void Checkpoint::write_string(std::ostream& out, const std::string& s) {
+    write_value<uint64_t>(out, s.size());
+    out.write(s.data(), s.size());
+}
+
+std::string Checkpoint::read_string(std::istream& in) {
+    uint64_t size = read_value<uint64_t>(in);
+    std::string s(size, '\0');
+    if (size > 0 && !in.read(&s[0], size))
+        throw std::runtime_error("Checkpoint file is truncated.");
+    return s;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <future>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Class writing periodic binary checkpoints of an optimization method.
+ *
+ * The state is serialized into a memory buffer by the optimization loop and written to disk
+ * by a background task, so the loop does not wait for the file system. The file is first written
+ * to a temporary file, synced to the disk and then renamed over the previous checkpoint, so a run
+ * killed in the middle of a write, or a crash of the system, leaves the last complete checkpoint in place.
+ *
+ * Data that only grows, such as the sequence of iterates, goes to a history file next to the checkpoint.
+ * Each checkpoint writes the new part at the offset where the previous one ended, before the state is
+ * renamed into place, and the state records how much of the history it covers. A write cut short
+ * leaves data past that point, which the next checkpoint overwrites.
+ */
+class Checkpoint {
+private:
+    std::string path; /**< Path of the checkpoint file. */
+    int interval; /**< Number of iterations between two checkpoints. */
+    int next_iter; /**< Iteration at which the next checkpoint is due. */
+    std::future<void> pending_write; /**< Background write that is currently in progress. */
+
+    /**
+     * @brief Writes the data to a temporary file and renames it over the checkpoint file.
+     * @param path_ Path of the checkpoint file.
+     * @param data Serialized state of the optimization method.
+     */
+    static void write_file(const std::string& path_, const std::string& data);
+
+    /**
+     * @brief Writes the new part of the history file and then the checkpoint file.
+     * @param path_ Path of the checkpoint file.
+     * @param data Serialized state of the optimization method.
+     * @param history Data appended to the history file.
+     * @param history_offset Offset in the history file at which the data is written.
+     */
+    static void write_files(const std::string& path_, const std::string& data, const std::string& history, uint64_t history_offset);
+
+public:
+    /**
+     * @brief Default constructor. Checkpoints are disabled.
+     */
+    Checkpoint();
+
+    /**
+     * @brief Constructor for the checkpoint writer.
+     * @param path_ Path of the checkpoint file.
+     * @param interval_ Number of iterations between two checkpoints.
+     */
+    Checkpoint(const std::string& path_, int interval_);
+
+    /**
+     * @brief Destructor. Waits for the write in progress.
+     */
+    ~Checkpoint();
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    /**
+     * @brief Checks whether checkpoints are enabled.
+     * @return True if the path and the interval are set, false otherwise.
+     */
+    bool is_enabled() const;
+
+    /**
+     * @brief Getter for the path of the checkpoint file.
+     * @return Path of the checkpoint file.
+     */
+    const std::string& get_path() const;
+
+    /**
+     * @brief Checks whether a checkpoint should be written at the given iteration.
+     * @param num_of_iter Current number of iterations.
+     * A checkpoint that falls on a moment when the previous write is still in progress
+     * is postponed to the first iteration after that write has finished.
+     * @return True if a checkpoint is due and the previous write has finished, false otherwise.
+     */
+    bool is_due(int num_of_iter);
+
+    /**
+     * @brief Starts writing the serialized state in the background.
+     * @param data Serialized state of the optimization method.
+     * @param history Data appended to the history file since the previous checkpoint.
+     * @param history_offset Size of the history covered by the previous checkpoint, in bytes.
+     * @param num_of_iter Iteration at which the state was taken.
+     */
+    void write_async(std::string data, std::string history, uint64_t history_offset, int num_of_iter);
+
+    /**
+     * @brief Writes the serialized state and waits until it is on disk.
+     * @param data Serialized state of the optimization method.
+     * @param history Data appended to the history file since the previous checkpoint.
+     * @param history_offset Size of the history covered by the previous checkpoint, in bytes.
+     */
+    void write(std::string data, std::string history, uint64_t history_offset);
+
+    /**
+     * @brief Waits for the write in progress.
+     */
+    void wait();
+
+    /**
+     * @brief Reads the whole checkpoint file.
+     * @param path_ Path of the checkpoint file.
+     * @return Content of the checkpoint file.
+     */
+    static std::string read_file(const std::string& path_);
+
+    /**
+     * @brief Gives the path of the history file that belongs to a checkpoint.
+     * @param path_ Path of the checkpoint file.
+     * @return Path of the history file.
+     */
+    static std::string history_path(const std::string& path_);
+
+    /**
+     * @brief Writes a value in binary form.
+     * @param out Output stream.
+     * @param value Value to be written.
+     */
+    template <typename T>
+    static void write_value(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @brief Reads a value written by write_value.
+     * @param in Input stream.
+     * @return Value read from the stream.
+     */
+    template <typename T>
+    static T read_value(std::istream& in) {
+        T value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T)))
+            throw std::runtime_error("Checkpoint file is truncated.");
+        return value;
+    }
+
+    /**
+     * @brief Writes a string with its length.
+     * @param out Output stream.
+     * @param s String to be written.
+     */
+    static void write_string(std::ostream& out, const std::string& s);
+
+    /**
+     * @brief Reads a string written by write_string.
+     * @param in Input stream.
+     * @return String read from the stream.
+     */
+    static std::string read_string(std::istream& in);
+};
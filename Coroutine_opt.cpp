@@ -0,0 +1,282 @@
+#include "Coroutine_opt.h"
+
+#if defined(__cpp_impl_coroutine) || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+Optimization_coroutine::Optimization_coroutine(std::coroutine_handle<promise_type> handle_) : handle(handle_) {}
+
+Optimization_coroutine::~Optimization_coroutine() {
+    if (handle)
+        handle.destroy();
+}
+
+Optimization_coroutine::Optimization_coroutine(Optimization_coroutine&& other) noexcept : handle(other.handle) {
+    other.handle = nullptr;
+}
+
+Optimization_coroutine& Optimization_coroutine::operator=(Optimization_coroutine&& other) noexcept {
+    if (this != &other) {
+        if (handle)
+            handle.destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+bool Optimization_coroutine::is_done() const {
+    if (handle.promise().error)
+        std::rethrow_exception(handle.promise().error);
+    return handle.done();
+}
+
+const Evaluation_request& Optimization_coroutine::get_request() const {
+    return handle.promise().request;
+}
+
+void Optimization_coroutine::resume(std::vector<double> values) {
+    if (is_done())
+        throw std::logic_error("Optimization coroutine has already finished.");
+    const Evaluation_request& request = handle.promise().request;
+    if (values.size() * request.dim != request.points.size())
+        throw std::invalid_argument("Number of values does not match the request.");
+
+    handle.promise().values = std::move(values);
+    handle.resume();
+}
+
+const Coroutine_result& Optimization_coroutine::get_result() const {
+    if (!is_done())
+        throw std::logic_error("Optimization coroutine has not finished yet.");
+    return handle.promise().result;
+}
+
+Optimization_coroutine Optimization_coroutine::newton(std::vector<double> x_0, Area area, double eps, int max_num_of_iterations) {
+    int dim = static_cast<int>(x_0.size());
+    std::vector<std::pair<double, double>> box = area.get_box();
+    // An empty box leaves the search unbounded; the exception is rethrown by is_done().
+    if (!box.empty() && !area.is_inside(x_0))
+        throw std::invalid_argument("Start point is outside the area.");
+    // Requests are named rather than temporaries in co_yield, which some compilers destroy twice.
+    Evaluation_request request{ dim, x_0 };
+    Coroutine_result result;
+    result.x = x_0;
+    result.num_of_iter = 0;
+    result.f = (co_yield std::move(request))[0];
+    result.num_of_evaluations = 1;
+
+    // Offsets p_i and q_i of coordinate i: central inside the area, both on the inner side at its border.
+    std::vector<double> p(dim), q(dim);
+    std::vector<double>& points = request.points;
+    std::vector<double> g(dim);
+    Eigen::MatrixXd h(dim, dim);
+
+    while (true) {
+        const std::vector<double>& x = result.x;
+        for (int i = 0; i < dim; ++i) {
+            double step = std::pow(DBL_EPSILON, 0.25) * std::max(std::fabs(x[i]), 1.0);
+            double lower = box.empty() ? -INFINITY : box[i].first, upper = box.empty() ? INFINITY : box[i].second;
+            if (x[i] - step >= lower && x[i] + step <= upper) {
+                p[i] = step;
+                q[i] = -step;
+            }
+            else {
+                double sign = x[i] + 2 * step <= upper ? 1 : -1;
+                p[i] = sign * step;
+                q[i] = 2 * sign * step;
+            }
+        }
+
+        // Stencil: x + p_i e_i and x + q_i e_i for every i, then the four corners of every pair i < j.
+        points.clear();
+        for (int i = 0; i < dim; ++i) {
+            for (double offset : { p[i], q[i] }) {
+                points.insert(points.end(), x.begin(), x.end());
+                points[points.size() - dim + i] += offset;
+            }
+        }
+        for (int i = 0; i < dim; ++i) {
+            for (int j = i + 1; j < dim; ++j) {
+                for (double offset_i : { p[i], q[i] }) {
+                    for (double offset_j : { p[j], q[j] }) {
+                        points.insert(points.end(), x.begin(), x.end());
+                        points[points.size() - dim + i] += offset_i;
+                        points[points.size() - dim + j] += offset_j;
+                    }
+                }
+            }
+        }
+        std::vector<double> values = co_yield std::move(request);
+        result.num_of_evaluations += static_cast<long long>(values.size());
+
+        // Derivatives of the parabola through (0, f), (p, f_p) and (q, f_q) along every coordinate.
+        double f = result.f;
+        double grad_norm = 0;
+        for (int i = 0; i < dim; ++i) {
+            double f_p = values[2 * i], f_q = values[2 * i + 1];
+            g[i] = -(p[i] + q[i]) / (p[i] * q[i]) * f - q[i] / (p[i] * (p[i] - q[i])) * f_p - p[i] / (q[i] * (q[i] - p[i])) * f_q;
+            h(i, i) = 2 * f / (p[i] * q[i]) + 2 * f_p / (p[i] * (p[i] - q[i])) + 2 * f_q / (q[i] * (q[i] - p[i]));
+            grad_norm += g[i] * g[i];
+        }
+        size_t corner = 2 * static_cast<size_t>(dim);
+        for (int i = 0; i < dim; ++i) {
+            for (int j = i + 1; j < dim; ++j) {
+                h(i, j) = h(j, i) = (values[corner] - values[corner + 1] - values[corner + 2] + values[corner + 3])
+                    / ((p[i] - q[i]) * (p[j] - q[j]));
+                corner += 4;
+            }
+        }
+
+        if (result.num_of_iter >= max_num_of_iterations || std::sqrt(grad_norm) < eps)
+            break;
+
+        Eigen::VectorXd direction = -(h.inverse() * Eigen::Map<const Eigen::VectorXd>(g.data(), dim));
+        // A singular Hessian or non-finite values at the stencil leave no direction to search along.
+        if (!direction.allFinite())
+            break;
+
+        double alpha = 1.0;
+        bool is_stopped = false;
+        while (true) {
+            // An underflowed step can no longer move the point, and a non-finite value cannot be compared.
+            if (!(alpha > DBL_MIN)) {
+                is_stopped = true;
+                break;
+            }
+            std::vector<double> new_x = result.x;
+            for (int i = 0; i < dim; ++i) {
+                new_x[i] += alpha * direction(i);
+            }
+
+            if (box.empty() || area.is_inside(new_x)) {
+                request.points = new_x;
+                double new_f = (co_yield std::move(request))[0];
+                ++result.num_of_evaluations;
+                if (!std::isfinite(new_f)) {
+                    is_stopped = true;
+                    break;
+                }
+                if (new_f <= result.f) {
+                    result.x = new_x;
+                    result.f = new_f;
+                    ++result.num_of_iter;
+                    break;
+                }
+            }
+            alpha *= 0.5;
+        }
+        if (is_stopped)
+            break;
+    }
+
+    co_return result;
+}
+
+Optimization_coroutine Optimization_coroutine::random_search(std::vector<double> x_0, Area area, int max_num_of_iterations,
+    double p, double delta, double alpha, unsigned seed) {
+    int dim = static_cast<int>(x_0.size());
+    std::vector<std::pair<double, double>> box = area.get_box();
+    // Points are drawn from the box, so it cannot be unbounded.
+    if (box.size() != x_0.size())
+        throw std::invalid_argument("Random search requires a bounded area of the start point dimension.");
+    if (!area.is_inside(x_0))
+        throw std::invalid_argument("Start point is outside the area.");
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(0, 1);
+
+    Evaluation_request request{ dim, x_0 };
+    Coroutine_result result;
+    result.x = x_0;
+    result.num_of_iter = 0;
+    result.f = (co_yield std::move(request))[0];
+    result.num_of_evaluations = 1;
+
+    double curr_delta = delta;
+    std::vector<double> new_x(dim);
+    while (result.num_of_iter < max_num_of_iterations) {
+        ++result.num_of_iter;
+
+        bool is_in_small_area = !(1 - p > distribution(generator));
+        for (int i = 0; i < dim; ++i) {
+            double min = box[i].first, max = box[i].second;
+            if (is_in_small_area) {
+                min = std::max(result.x[i] - curr_delta, box[i].first);
+                max = std::min(result.x[i] + curr_delta, box[i].second);
+            }
+            new_x[i] = min + distribution(generator) * (max - min);
+        }
+
+        request.points = new_x;
+        double new_f = (co_yield std::move(request))[0];
+        ++result.num_of_evaluations;
+        if (new_f < result.f) {
+            curr_delta = is_in_small_area ? curr_delta * alpha : delta;
+            result.x = new_x;
+            result.f = new_f;
+        }
+    }
+
+    co_return result;
+}
+
+
+Coroutine_scheduler::Coroutine_scheduler(int dim_) : dim(dim_), num_of_batches(0), num_of_points(0) {
+    if (dim <= 0)
+        throw std::invalid_argument("Dimension must be positive.");
+}
+
+int Coroutine_scheduler::add(Optimization_coroutine coroutine) {
+    if (!coroutine.is_done() && coroutine.get_request().dim != dim)
+        throw std::invalid_argument("Coroutine dimension does not match the scheduler.");
+    coroutines.push_back(std::move(coroutine));
+    return static_cast<int>(coroutines.size()) - 1;
+}
+
+void Coroutine_scheduler::run(const Batch_evaluator& evaluator) {
+    std::vector<double> points, values;
+    std::vector<size_t> offsets;
+
+    while (true) {
+        points.clear();
+        offsets.assign(1, 0);
+        for (Optimization_coroutine& coroutine : coroutines) {
+            if (!coroutine.is_done()) {
+                const std::vector<double>& request = coroutine.get_request().points;
+                points.insert(points.end(), request.begin(), request.end());
+            }
+            offsets.push_back(points.size() / dim);
+        }
+        if (points.empty())
+            break;
+
+        int n = static_cast<int>(points.size() / dim);
+        values.assign(n, 0);
+        evaluator(points.data(), n, values.data());
+        ++num_of_batches;
+        num_of_points += n;
+
+        for (size_t c = 0; c < coroutines.size(); ++c) {
+            if (offsets[c + 1] > offsets[c])
+                coroutines[c].resume(std::vector<double>(values.begin() + offsets[c], values.begin() + offsets[c + 1]));
+        }
+    }
+}
+
+const Coroutine_result& Coroutine_scheduler::get_result(int i) const {
+    return coroutines.at(i).get_result();
+}
+
+long long Coroutine_scheduler::get_num_of_batches() const {
+    return num_of_batches;
+}
+
+long long Coroutine_scheduler::get_num_of_points() const {
+    return num_of_points;
+}
+
+#endif
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "Area.h"
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <coroutine>
+
+/**
+ * @brief Points an optimization coroutine needs evaluated before it can continue.
+ */
+struct Evaluation_request {
+    int dim; /**< Dimension of the points. */
+    std::vector<double> points; /**< Coordinates, points[k * dim + i] is coordinate i of point k. */
+};
+
+/**
+ * @brief Result of an optimization coroutine.
+ */
+struct Coroutine_result {
+    std::vector<double> x; /**< Best point. */
+    double f; /**< Function value at the best point. */
+    int num_of_iter; /**< Number of iterations. */
+    long long num_of_evaluations; /**< Number of evaluated points. */
+};
+
+/**
+ * @brief Optimization method in the form of a C++20 coroutine that never evaluates the function itself.
+ *
+ * The coroutine runs until it needs function values, publishes the points as a request and suspends;
+ * resume() passes the values in and runs it to the next request or to the end. The caller decides how
+ * and when the points are evaluated, so one thread can advance many optimizations and evaluate the
+ * requests of all of them together. Every request of Newton's method holds the whole finite-difference
+ * stencil of an iteration, every line search trial is a request of one point.
+ */
+class Optimization_coroutine {
+public:
+    /**
+     * @brief Promise of the coroutine, holding the current request, the values and the result.
+     */
+    struct promise_type {
+        Evaluation_request request; /**< Current request. */
+        std::vector<double> values; /**< Values of the current request. */
+        Coroutine_result result; /**< Result, valid once the coroutine is done. */
+        std::exception_ptr error; /**< Exception thrown by the body. */
+
+        Optimization_coroutine get_return_object() {
+            return Optimization_coroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        /**
+         * @brief Awaiter suspending the coroutine at a request and returning the values on resumption.
+         */
+        struct Value_awaiter {
+            promise_type& promise; /**< Promise receiving the values. */
+
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<promise_type>) const noexcept {}
+
+            std::vector<double> await_resume() const {
+                return std::move(promise.values);
+            }
+        };
+
+        Value_awaiter yield_value(Evaluation_request&& request_) {
+            request = std::move(request_);
+            return Value_awaiter{ *this };
+        }
+
+        void return_value(Coroutine_result result_) {
+            result = std::move(result_);
+            request.points.clear();
+        }
+
+        void unhandled_exception() {
+            error = std::current_exception();
+            request.points.clear();
+        }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle; /**< Handle of the coroutine frame, owned by the object. */
+
+    /**
+     * @brief Constructor taking the handle of a new coroutine.
+     * @param handle_ Handle of the coroutine frame.
+     */
+    explicit Optimization_coroutine(std::coroutine_handle<promise_type> handle_);
+
+public:
+    /**
+     * @brief Destructor. Destroys the coroutine frame.
+     */
+    ~Optimization_coroutine();
+
+    Optimization_coroutine(Optimization_coroutine&& other) noexcept;
+    Optimization_coroutine& operator=(Optimization_coroutine&& other) noexcept;
+    Optimization_coroutine(const Optimization_coroutine&) = delete;
+    Optimization_coroutine& operator=(const Optimization_coroutine&) = delete;
+
+    /**
+     * @brief Checks whether the optimization has finished. Rethrows an exception of the body.
+     * @return True if the result is available.
+     */
+    bool is_done() const;
+
+    /**
+     * @brief Getter for the current request.
+     * @return Points to be evaluated, empty once the coroutine is done.
+     */
+    const Evaluation_request& get_request() const;
+
+    /**
+     * @brief Passes the values of the current request and runs the coroutine to the next request.
+     * @param values Function values of the points of the request, in the same order.
+     */
+    void resume(std::vector<double> values);
+
+    /**
+     * @brief Getter for the result.
+     * @return Result of the finished optimization.
+     */
+    const Coroutine_result& get_result() const;
+
+    /**
+     * @brief Newton's method with finite-difference derivatives, stopping like Criterion_grad_f.
+     * The derivatives come from a quadratic stencil of 2 * dim^2 points per iteration, one-sided at the
+     * border of the area; the line search halves the step until the function does not increase. The
+     * search also ends when the step underflows or the function returns a non-finite value. An area with an
+     * empty box is unbounded; a start point outside a bounded area makes is_done() throw std::invalid_argument.
+     * @param x_0 Initial point.
+     * @param area Area constraint for optimization.
+     * @param eps Tolerance of the gradient norm.
+     * @param max_num_of_iterations Maximum number of iterations.
+     * @return Coroutine waiting for the value of the initial point.
+     */
+    static Optimization_coroutine newton(std::vector<double> x_0, Area area, double eps, int max_num_of_iterations = 100);
+
+    /**
+     * @brief Random search with the steps of Random_search, stopping like Criterion_max_iter.
+     * The area must be bounded and contain x_0, otherwise is_done() throws std::invalid_argument.
+     * @param x_0 Initial point.
+     * @param area Area constraint for optimization.
+     * @param max_num_of_iterations Number of iterations.
+     * @param p Probability parameter for determining the search strategy.
+     * @param delta Initial radius neighborhood of a point.
+     * @param alpha Coefficient that diminishes the size of the delta neighborhood around a given point.
+     * @param seed Seed of the random number generator.
+     * @return Coroutine waiting for the value of the initial point.
+     */
+    static Optimization_coroutine random_search(std::vector<double> x_0, Area area, int max_num_of_iterations,
+        double p = 0.5, double delta = 1, double alpha = 1, unsigned seed = 0);
+};
+
+/**
+ * @brief Single-threaded scheduler advancing many optimization coroutines of the same dimension.
+ *
+ * Every round gathers the requests of all unfinished coroutines into one batch, evaluates it with one
+ * call and resumes every coroutine with its values, until all are done.
+ */
+class Coroutine_scheduler {
+public:
+    /**
+     * @brief Function evaluating n points at once: points[k * dim + i] is coordinate i of point k.
+     */
+    typedef std::function<void(const double* points, int n, double* values)> Batch_evaluator;
+
+private:
+    int dim; /**< Dimension of the points. */
+    std::vector<Optimization_coroutine> coroutines; /**< Scheduled coroutines. */
+    long long num_of_batches; /**< Number of evaluator calls. */
+    long long num_of_points; /**< Number of evaluated points. */
+
+public:
+    /**
+     * @brief Constructor for the scheduler.
+     * @param dim_ Dimension of the points.
+     */
+    explicit Coroutine_scheduler(int dim_);
+
+    /**
+     * @brief Adds a coroutine.
+     * @param coroutine Coroutine, owned by the scheduler afterwards.
+     * @return Index of the coroutine.
+     */
+    int add(Optimization_coroutine coroutine);
+
+    /**
+     * @brief Runs all coroutines to the end.
+     * @param evaluator Function evaluating the batches.
+     */
+    void run(const Batch_evaluator& evaluator);
+
+    /**
+     * @brief Getter for the result of a coroutine.
+     * @param i Index of the coroutine.
+     * @return Result of the finished optimization.
+     */
+    const Coroutine_result& get_result(int i) const;
+
+    /**
+     * @brief Getter for the number of evaluator calls.
+     * @return Number of batches.
+     */
+    long long get_num_of_batches() const;
+
+    /**
+     * @brief Getter for the number of evaluated points.
+     * @return Number of points in all batches.
+     */
+    long long get_num_of_points() const;
+};
+
+#endif
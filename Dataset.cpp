@@ -0,0 +1,356 @@
+#include "Dataset.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint32_t dataset_magic = 0x44504F4E; // "NOPD"
+    const uint32_t dataset_version = 1;
+    const size_t header_size = 64;
+
+    /**
+     * @brief Beginning of a dataset file, padded to header_size bytes.
+     */
+    struct Dataset_header {
+        uint32_t magic; /**< dataset_magic. */
+        uint32_t version; /**< dataset_version. */
+        uint64_t num_of_rows; /**< Number of rows. */
+        uint64_t num_of_columns; /**< Number of columns. */
+    };
+
+    size_t column_stride(uint64_t num_of_rows) {
+        return (num_of_rows * sizeof(double) + 63) / 64 * 64;
+    }
+
+    // Four independent partial sums let the compiler vectorize the reduction without reordering a single sum.
+    double dot(const double* a, const double* b, int n) {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        int k = 0;
+        for (; k + 4 <= n; k += 4) {
+            s0 += a[k] * b[k];
+            s1 += a[k + 1] * b[k + 1];
+            s2 += a[k + 2] * b[k + 2];
+            s3 += a[k + 3] * b[k + 3];
+        }
+        for (; k < n; ++k) {
+            s0 += a[k] * b[k];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    double sum(const double* a, int n) {
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        int k = 0;
+        for (; k + 4 <= n; k += 4) {
+            s0 += a[k];
+            s1 += a[k + 1];
+            s2 += a[k + 2];
+            s3 += a[k + 3];
+        }
+        for (; k < n; ++k) {
+            s0 += a[k];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+}
+
+Mapped_dataset::Mapped_dataset(const std::string& path_) : path(path_), data(nullptr), size(0), num_of_rows(0), num_of_columns(0) {
+#ifdef _WIN32
+    mapping_handle = nullptr;
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open dataset file " + path + ".");
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_handle, &file_size);
+    size = static_cast<size_t>(file_size.QuadPart);
+    mapping_handle = size > 0 ? CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mapping_handle != nullptr)
+        data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        if (mapping_handle != nullptr)
+            CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        throw std::runtime_error("Cannot map dataset file " + path + ".");
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open dataset file " + path + ".");
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Cannot map dataset file " + path + ".");
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+        throw std::runtime_error("Cannot map dataset file " + path + ".");
+    madvise(memory, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(memory);
+#endif
+
+    Dataset_header header;
+    bool is_valid = size >= header_size;
+    if (is_valid) {
+        std::memcpy(&header, data, sizeof(header));
+        is_valid = header.magic == dataset_magic && header.version == dataset_version && header.num_of_rows < (1ULL << 58)
+            && header.num_of_columns > 0
+            && header.num_of_columns <= (size - header_size) / std::max<size_t>(column_stride(header.num_of_rows), 64);
+    }
+    if (!is_valid) {
+        unmap();
+        throw std::runtime_error("Invalid dataset file " + path + ".");
+    }
+    num_of_rows = header.num_of_rows;
+    num_of_columns = header.num_of_columns;
+}
+
+Mapped_dataset::~Mapped_dataset() {
+    unmap();
+}
+
+void Mapped_dataset::unmap() {
+    if (data == nullptr)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+#else
+    munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+}
+
+size_t Mapped_dataset::get_num_of_rows() const {
+    return static_cast<size_t>(num_of_rows);
+}
+
+int Mapped_dataset::get_num_of_columns() const {
+    return static_cast<int>(num_of_columns);
+}
+
+const double* Mapped_dataset::column(int j) const {
+    if (j < 0 || static_cast<uint64_t>(j) >= num_of_columns)
+        throw std::out_of_range("Dataset column index is out of range.");
+    return reinterpret_cast<const double*>(data + header_size + j * column_stride(num_of_rows));
+}
+
+void Mapped_dataset::write(const std::string& path, const std::vector<std::vector<double>>& columns) {
+    if (columns.empty())
+        throw std::invalid_argument("Dataset must have at least one column.");
+    for (const std::vector<double>& column : columns) {
+        if (column.size() != columns[0].size())
+            throw std::invalid_argument("Dataset columns must have equal length.");
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Cannot open dataset file " + path + ".");
+
+    char header[header_size] = {};
+    Dataset_header fields = { dataset_magic, dataset_version, columns[0].size(), columns.size() };
+    std::memcpy(header, &fields, sizeof(fields));
+    out.write(header, header_size);
+
+    size_t stride = column_stride(columns[0].size());
+    std::vector<char> padding(stride - columns[0].size() * sizeof(double), 0);
+    for (const std::vector<double>& column : columns) {
+        out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(double));
+        out.write(padding.data(), padding.size());
+    }
+    if (!out)
+        throw std::runtime_error("Cannot write dataset file " + path + ".");
+}
+
+
+Dataset_function::Dataset_function(std::shared_ptr<const Mapped_dataset> dataset_, int num_of_threads, int block_size_)
+    : Function(dataset_ ? dataset_->get_num_of_columns() : 0), dataset(dataset_), pool(new Thread_pool(num_of_threads)),
+    block_size(std::max(block_size_, 1)) {
+    if (!dataset || dataset->get_num_of_rows() == 0)
+        throw std::invalid_argument("Dataset must not be empty.");
+}
+
+std::shared_ptr<const Mapped_dataset> Dataset_function::get_dataset() const {
+    return dataset;
+}
+
+double Dataset_function::reduce_block(const double* x_, size_t begin, size_t end, double* g, double* h,
+    double* z, double* d1, double* d2) const {
+    int n = static_cast<int>(end - begin);
+    int num_of_features = dim - 1;
+
+    // Linear predictor, one feature column at a time over the cached block.
+    std::fill(z, z + n, x_[num_of_features]);
+    for (int j = 0; j < num_of_features; ++j) {
+        const double* a = dataset->column(j) + begin;
+        double x_j = x_[j];
+        for (int k = 0; k < n; ++k) {
+            z[k] += x_j * a[k];
+        }
+    }
+
+    double loss = pointwise(z, dataset->column(num_of_features) + begin, n, g ? d1 : nullptr, h ? d2 : nullptr);
+
+    if (g) {
+        for (int j = 0; j < num_of_features; ++j) {
+            g[j] += dot(d1, dataset->column(j) + begin, n);
+        }
+        g[num_of_features] += sum(d1, n);
+    }
+
+    if (h) {
+        // The intercept is a column of ones; only the upper triangle is summed.
+        for (int i = 0; i < dim; ++i) {
+            const double* a_i = i < num_of_features ? dataset->column(i) + begin : nullptr;
+            for (int k = 0; k < n; ++k) {
+                z[k] = a_i ? d2[k] * a_i[k] : d2[k];
+            }
+            for (int j = i; j < dim; ++j) {
+                h[i * dim + j] += j < num_of_features ? dot(z, dataset->column(j) + begin, n) : sum(z, n);
+            }
+        }
+    }
+    return loss;
+}
+
+double Dataset_function::reduce(const double* x_, double* g, double* h) const {
+    size_t num_of_rows = dataset->get_num_of_rows();
+    int num_of_blocks = static_cast<int>((num_of_rows + block_size - 1) / block_size);
+
+    // Partial sums of every thread: the loss, then the gradient, then the Hessian matrix.
+    size_t g_offset = 1, h_offset = g_offset + (g ? dim : 0);
+    size_t length = h_offset + (h ? static_cast<size_t>(dim) * dim : 0);
+    std::vector<std::vector<double>> partials(pool->get_num_of_threads());
+
+    pool->parallel_for(num_of_blocks, [&](int begin, int end, int thread) {
+        std::vector<double>& partial = partials[thread];
+        partial.assign(length, 0);
+        std::vector<double> buffers(3 * static_cast<size_t>(block_size));
+        double* z = buffers.data();
+        for (int b = begin; b < end; ++b) {
+            size_t first = static_cast<size_t>(b) * block_size;
+            size_t last = std::min(first + block_size, num_of_rows);
+            partial[0] += reduce_block(x_, first, last, g ? &partial[g_offset] : nullptr, h ? &partial[h_offset] : nullptr,
+                z, z + block_size, z + 2 * static_cast<size_t>(block_size));
+        }
+    });
+
+    std::vector<double> total(length, 0);
+    for (const std::vector<double>& partial : partials) {
+        for (size_t i = 0; i < partial.size(); ++i) {
+            total[i] += partial[i];
+        }
+    }
+
+    double scale = 1.0 / num_of_rows;
+    if (g) {
+        for (int i = 0; i < dim; ++i) {
+            g[i] = total[g_offset + i] * scale;
+        }
+    }
+    if (h) {
+        for (int i = 0; i < dim; ++i) {
+            for (int j = i; j < dim; ++j) {
+                h[i * dim + j] = h[j * dim + i] = total[h_offset + i * dim + j] * scale;
+            }
+        }
+    }
+    return total[0] * scale;
+}
+
+double Dataset_function::calculate(const std::vector<double>& x_) {
+    f = reduce(x_.data(), nullptr, nullptr);
+    return f;
+}
+
+std::vector<double> Dataset_function::gradient(std::vector<double> x_, double, const Area&) {
+    std::vector<double> result(dim);
+    reduce(x_.data(), result.data(), nullptr);
+    return result;
+}
+
+std::vector<std::vector<double>> Dataset_function::hessian(std::vector<double> x_, double, const Area&) {
+    std::vector<double> matrix(static_cast<size_t>(dim) * dim);
+    reduce(x_.data(), nullptr, matrix.data());
+
+    std::vector<std::vector<double>> result(dim, std::vector<double>(dim));
+    for (int i = 0; i < dim; ++i) {
+        std::copy(matrix.begin() + i * dim, matrix.begin() + (i + 1) * dim, result[i].begin());
+    }
+    return result;
+}
+
+bool Dataset_function::has_analytic_derivatives() const {
+    return true;
+}
+
+
+Linear_regression::Linear_regression(std::shared_ptr<const Mapped_dataset> dataset_, int num_of_threads)
+    : Dataset_function(dataset_, num_of_threads) {}
+
+Function* Linear_regression::clone() const {
+    return new Linear_regression(get_dataset(), 1);
+}
+
+double Linear_regression::pointwise(const double* z, const double* y, int n, double* d1, double* d2) const {
+    double s0 = 0, s1 = 0;
+    int k = 0;
+    for (; k + 2 <= n; k += 2) {
+        double e0 = z[k] - y[k], e1 = z[k + 1] - y[k + 1];
+        s0 += e0 * e0;
+        s1 += e1 * e1;
+    }
+    for (; k < n; ++k) {
+        s0 += (z[k] - y[k]) * (z[k] - y[k]);
+    }
+    if (d1) {
+        for (k = 0; k < n; ++k) {
+            d1[k] = 2 * (z[k] - y[k]);
+        }
+    }
+    if (d2) {
+        std::fill(d2, d2 + n, 2.0);
+    }
+    return s0 + s1;
+}
+
+
+Logistic_regression::Logistic_regression(std::shared_ptr<const Mapped_dataset> dataset_, int num_of_threads)
+    : Dataset_function(dataset_, num_of_threads) {}
+
+Function* Logistic_regression::clone() const {
+    return new Logistic_regression(get_dataset(), 1);
+}
+
+double Logistic_regression::pointwise(const double* z, const double* y, int n, double* d1, double* d2) const {
+    double loss = 0;
+    for (int k = 0; k < n; ++k) {
+        // log(1 + e^z) without overflow.
+        loss += std::max(z[k], 0.0) + std::log1p(std::exp(-std::fabs(z[k]))) - y[k] * z[k];
+    }
+    if (d1 || d2) {
+        for (int k = 0; k < n; ++k) {
+            double p = 1 / (1 + std::exp(-z[k]));
+            if (d1)
+                d1[k] = p - y[k];
+            if (d2)
+                d2[k] = p * (1 - p);
+        }
+    }
+    return loss;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Thread_pool.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+/**
+ * @brief Read-only columnar dataset mapped into memory from a binary file.
+ *
+ * The file starts with a 64-byte header (magic "NOPD", version, number of rows and of columns, all
+ * little-endian) followed by the columns, each an array of doubles starting at a multiple of 64 bytes.
+ * The columns are read straight from the page cache: nothing is copied into process memory, and
+ * several processes mapping the same file share the pages.
+ */
+class Mapped_dataset {
+private:
+    std::string path; /**< Path to the file. */
+    const char* data; /**< Beginning of the mapping. */
+    size_t size; /**< Size of the mapping in bytes. */
+    uint64_t num_of_rows; /**< Number of rows. */
+    uint64_t num_of_columns; /**< Number of columns. */
+#ifdef _WIN32
+    void* file_handle; /**< Handle of the file. */
+    void* mapping_handle; /**< Handle of the file mapping. */
+#endif
+
+    /**
+     * @brief Unmaps the file if it is mapped.
+     */
+    void unmap();
+
+public:
+    /**
+     * @brief Constructor mapping a dataset file.
+     * @param path_ Path to the file.
+     */
+    explicit Mapped_dataset(const std::string& path_);
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~Mapped_dataset();
+
+    Mapped_dataset(const Mapped_dataset&) = delete;
+    Mapped_dataset& operator=(const Mapped_dataset&) = delete;
+
+    /**
+     * @brief Getter for the number of rows.
+     * @return Number of rows.
+     */
+    size_t get_num_of_rows() const;
+
+    /**
+     * @brief Getter for the number of columns.
+     * @return Number of columns.
+     */
+    int get_num_of_columns() const;
+
+    /**
+     * @brief Getter for a column.
+     * @param j Index of the column.
+     * @return Pointer to the num_of_rows values of the column, aligned to 64 bytes.
+     */
+    const double* column(int j) const;
+
+    /**
+     * @brief Writes columns to a dataset file.
+     * @param path Path to the file.
+     * @param columns Columns of equal length.
+     */
+    static void write(const std::string& path, const std::vector<std::vector<double>>& columns);
+};
+
+/**
+ * @brief Loss of a linear model summed over the rows of a mapped dataset.
+ *
+ * The last column of the dataset is the target y, the others are the features a. The point x holds a
+ * coefficient per feature followed by the intercept, so dim is the number of columns. The function is
+ * f(x) = (1 / n) * sum_k loss(z_k, y_k) with the linear predictor z_k = a_k^T x; derived classes define
+ * the pointwise loss. The value, the gradient and the Hessian matrix are reductions over blocks of rows:
+ * the blocks are split across the threads, every block is small enough to stay in cache while all its
+ * columns are processed, and the inner loops run over contiguous columns so that the compiler vectorizes
+ * them. The partial sums are combined in a fixed order, so the result does not depend on the timing.
+ */
+class Dataset_function : public Function {
+private:
+    std::shared_ptr<const Mapped_dataset> dataset; /**< Dataset shared by the copies of the function. */
+    std::unique_ptr<Thread_pool> pool; /**< Threads computing the reductions. */
+    int block_size; /**< Number of rows in a block. */
+
+    /**
+     * @brief Computes the sums of the loss and optionally of its derivatives over all rows.
+     * @param x_ Array of dim coordinates.
+     * @param g Array of dim values receiving the gradient, or null.
+     * @param h Array of dim * dim values receiving the Hessian matrix, or null.
+     * @return Function value.
+     */
+    double reduce(const double* x_, double* g, double* h) const;
+
+    /**
+     * @brief Adds the sums over the rows [begin, end) to the partial sums of a thread.
+     * @param x_ Array of dim coordinates.
+     * @param begin First row.
+     * @param end Row after the last one, at most block_size rows after begin.
+     * @param g Partial gradient, or null.
+     * @param h Partial Hessian matrix, upper triangle, or null.
+     * @param z Buffer of block_size values.
+     * @param d1 Buffer of block_size values.
+     * @param d2 Buffer of block_size values.
+     * @return Sum of the loss over the rows.
+     */
+    double reduce_block(const double* x_, size_t begin, size_t end, double* g, double* h, double* z, double* d1, double* d2) const;
+
+protected:
+    /**
+     * @brief Pure virtual function calculating the loss of a block of rows and its derivatives by z.
+     * @param z Linear predictors of the rows.
+     * @param y Targets of the rows.
+     * @param n Number of rows.
+     * @param d1 Array of n values receiving the first derivatives, or null.
+     * @param d2 Array of n values receiving the second derivatives, or null.
+     * @return Sum of the loss over the rows.
+     */
+    virtual double pointwise(const double* z, const double* y, int n, double* d1, double* d2) const = 0;
+
+public:
+    /**
+     * @brief Constructor for the loss over a dataset.
+     * @param dataset_ Mapped dataset with at least one column.
+     * @param num_of_threads Number of threads of the reductions, 0 for the number of hardware threads.
+     * @param block_size_ Number of rows processed together, chosen so that the block of every column stays in cache.
+     */
+    Dataset_function(std::shared_ptr<const Mapped_dataset> dataset_, int num_of_threads = 0, int block_size_ = 2048);
+
+    /**
+     * @brief Getter for the dataset.
+     * @return Mapped dataset.
+     */
+    std::shared_ptr<const Mapped_dataset> get_dataset() const;
+
+    /**
+     * @brief Calculates the function value.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    double calculate(const std::vector<double>& x_) override;
+
+    /**
+     * @brief Calculates the exact gradient in one pass over the data. The step and the area are ignored.
+     * @param x_ Point at which the gradient is calculated.
+     * @param h Ignored.
+     * @param a Ignored.
+     * @return Gradient vector.
+     */
+    std::vector<double> gradient(std::vector<double> x_, double h, const Area& a) override;
+
+    /**
+     * @brief Calculates the exact Hessian matrix in one pass over the data. The step and the area are ignored.
+     * @param x_ Point at which the Hessian is calculated.
+     * @param h Ignored.
+     * @param a Ignored.
+     * @return Hessian matrix.
+     */
+    std::vector<std::vector<double>> hessian(std::vector<double> x_, double h, const Area& a) override;
+
+    /**
+     * @brief Checks whether gradient() and hessian() are computed analytically.
+     * @return True.
+     */
+    bool has_analytic_derivatives() const override;
+};
+
+/**
+ * @brief Mean squared error of a linear regression, loss(z, y) = (z - y)^2.
+ */
+class Linear_regression : public Dataset_function {
+protected:
+    double pointwise(const double* z, const double* y, int n, double* d1, double* d2) const override;
+
+public:
+    /**
+     * @brief Constructor for the regression over a dataset.
+     * @param dataset_ Mapped dataset, the last column is the target.
+     * @param num_of_threads Number of threads of the reductions, 0 for the number of hardware threads.
+     */
+    explicit Linear_regression(std::shared_ptr<const Mapped_dataset> dataset_, int num_of_threads = 0);
+
+    /**
+     * @brief Creates a copy sharing the dataset. The copy computes on the calling thread, as copies serve parallel callers.
+     * @return Pointer to the copy.
+     */
+    Function* clone() const override;
+};
+
+/**
+ * @brief Mean cross-entropy of a logistic regression, loss(z, y) = log(1 + e^z) - y * z for y in [0; 1].
+ */
+class Logistic_regression : public Dataset_function {
+protected:
+    double pointwise(const double* z, const double* y, int n, double* d1, double* d2) const override;
+
+public:
+    /**
+     * @brief Constructor for the regression over a dataset.
+     * @param dataset_ Mapped dataset, the last column is the label.
+     * @param num_of_threads Number of threads of the reductions, 0 for the number of hardware threads.
+     */
+    explicit Logistic_regression(std::shared_ptr<const Mapped_dataset> dataset_, int num_of_threads = 0);
+
+    /**
+     * @brief Creates a copy sharing the dataset. The copy computes on the calling thread, as copies serve parallel callers.
+     * @return Pointer to the copy.
+     */
+    Function* clone() const override;
+};
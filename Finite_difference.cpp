@@ -0,0 +1,158 @@
+#include "Finite_difference.h"
+#include <cmath>
+#include <algorithm>
+
+Finite_difference::Finite_difference(double noise_, bool is_richardson_, int refresh_interval_)
+    : noise(noise_), is_richardson(is_richardson_), refresh_interval(refresh_interval_), num_of_gradients(0) {}
+
+double Finite_difference::step(const std::vector<double>& x, int i) const {
+    return rel_steps[i] * std::max(std::abs(x[i]), 1.0);
+}
+
+std::vector<double> Finite_difference::get_steps(const std::vector<double>& x) const {
+    std::vector<double> steps(rel_steps.size());
+    for (int i = 0; i < static_cast<int>(rel_steps.size()); ++i) {
+        steps[i] = step(x, i);
+    }
+    return steps;
+}
+
+double Finite_difference::central(Function* function, std::vector<double>& x, int i, double h) {
+    double x_i = x[i];
+    x[i] = x_i + h;
+    double f_upper = function->evaluate(x);
+    x[i] = x_i - h;
+    double f_lower = function->evaluate(x);
+    x[i] = x_i;
+    return (f_upper - f_lower) / (2 * h);
+}
+
+void Finite_difference::estimate_steps(Function* function, const std::vector<double>& x, const Area& a) {
+    int dim = function->get_dim();
+    double default_rel_step = std::cbrt(noise);
+    rel_steps.assign(dim, default_rel_step);
+
+    double f_x = function->evaluate(x);
+    double eps_f = noise * std::max(std::abs(f_x), 1.0);
+    std::vector<double> x_probe = x;
+
+    for (int i = 0; i < dim; ++i) {
+        double scale = std::max(std::abs(x[i]), 1.0);
+        // The probe step is large enough for the third difference not to be swamped by noise.
+        double h_0 = std::pow(noise, 0.2) * scale;
+
+        double f_probe[4];
+        double offsets[4] = { 2 * h_0, h_0, -h_0, -2 * h_0 };
+        bool is_inside = true;
+        for (int k = 0; k < 4 && is_inside; ++k) {
+            x_probe[i] = x[i] + offsets[k];
+            is_inside = a.is_inside(x_probe);
+            if (is_inside)
+                f_probe[k] = function->evaluate(x_probe);
+        }
+        x_probe[i] = x[i];
+        if (!is_inside)
+            continue;
+
+        // Central difference error: h^2 |f'''| / 6 + eps_f / h, minimal at h = (3 eps_f / |f'''|)^(1/3).
+        double third = std::abs(f_probe[0] - 2 * f_probe[1] + 2 * f_probe[2] - f_probe[3]) / (2 * h_0 * h_0 * h_0);
+        double h = default_rel_step * scale * 100;
+        if (third > 0)
+            h = std::min(std::cbrt(3 * eps_f / third), h);
+        h = std::max(h, default_rel_step * scale / 100);
+
+        // Extrapolation removes the h^2 term, so the optimal step grows from eps^(1/3) to eps^(1/5).
+        if (is_richardson)
+            h *= std::pow(noise, -2.0 / 15);
+
+        rel_steps[i] = h / scale;
+    }
+}
+
+std::vector<double> Finite_difference::difference(Function* function, const std::vector<double>& x, const Area& a) {
+    int dim = function->get_dim();
+    std::vector<double> result(dim, 0);
+    std::vector<double> x_upper = x, x_lower = x, x_ = x;
+    bool is_f_x_known = false;
+    double f_x = 0;
+
+    for (int i = 0; i < dim; ++i) {
+        double h = step(x, i);
+        x_upper[i] += h;
+        x_lower[i] -= h;
+
+        if (a.is_inside(x_upper) && a.is_inside(x_lower)) {
+            result[i] = central(function, x_, i, h);
+            if (is_richardson)
+                result[i] = (4 * central(function, x_, i, h / 2) - result[i]) / 3;
+        }
+        else {
+            if (!is_f_x_known) {
+                f_x = function->evaluate(x);
+                is_f_x_known = true;
+            }
+            if (a.is_inside(x_upper))
+                result[i] = (function->evaluate(x_upper) - f_x) / h;
+            else
+                result[i] = (f_x - function->evaluate(x_lower)) / h;
+        }
+
+        x_upper[i] = x[i];
+        x_lower[i] = x[i];
+    }
+
+    return result;
+}
+
+std::vector<double> Finite_difference::gradient(Function* function, const std::vector<double>& x, const Area& a) {
+    if (static_cast<int>(rel_steps.size()) != function->get_dim() || num_of_gradients >= refresh_interval) {
+        estimate_steps(function, x, a);
+        num_of_gradients = 0;
+    }
+    ++num_of_gradients;
+    return difference(function, x, a);
+}
+
+std::vector<std::vector<double>> Finite_difference::hessian(Function* function, const std::vector<double>& x, const Area& a) {
+    int dim = function->get_dim();
+    if (static_cast<int>(rel_steps.size()) != dim)
+        estimate_steps(function, x, a);
+
+    std::vector<std::vector<double>> result(dim, std::vector<double>(dim, 0));
+    std::vector<double> x_upper = x, x_lower = x;
+    std::vector<double> grad_x;
+
+    // Differences of gradients behave like second differences, whose optimal step is of order eps^(1/4).
+    double outer_factor = std::pow(noise, -1.0 / 12);
+
+    for (int i = 0; i < dim; ++i) {
+        if (function->is_interrupted())
+            break;
+        double h = step(x, i) * outer_factor;
+        x_upper[i] += h;
+        x_lower[i] -= h;
+
+        bool is_upper_inside = a.is_inside(x_upper), is_lower_inside = a.is_inside(x_lower);
+        if (!(is_upper_inside && is_lower_inside) && grad_x.empty())
+            grad_x = difference(function, x, a);
+
+        std::vector<double> grad_upper = is_upper_inside ? difference(function, x_upper, a) : grad_x;
+        std::vector<double> grad_lower = is_lower_inside ? difference(function, x_lower, a) : grad_x;
+        double width = (is_upper_inside && is_lower_inside) ? 2 * h : h;
+
+        for (int j = 0; j < dim; ++j) {
+            result[i][j] = (grad_upper[j] - grad_lower[j]) / width;
+        }
+
+        x_upper[i] = x[i];
+        x_lower[i] = x[i];
+    }
+
+    for (int i = 0; i < dim; ++i) {
+        for (int j = 0; j < i; ++j) {
+            result[i][j] = result[j][i] = (result[i][j] + result[j][i]) / 2;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include <iostream>
+#include <vector>
+#include <cfloat>
+
+/**
+ * @brief Class computing finite-difference derivatives with a separate step for every coordinate.
+ *
+ * The step of coordinate i balances the truncation error, estimated from the third derivative
+ * along the coordinate, against the rounding error of the function values. The steps are kept
+ * relative to max(|x_i|, 1) and re-estimated every refresh_interval gradients, so most gradients
+ * cost exactly 2 * dim evaluations (4 * dim with Richardson extrapolation).
+ */
+class Finite_difference {
+private:
+    double noise; /**< Relative noise of the function values. */
+    bool is_richardson; /**< True if the central differences are refined by Richardson extrapolation. */
+    int refresh_interval; /**< Number of gradients after which the steps are estimated again. */
+    int num_of_gradients; /**< Number of gradients since the last estimation of the steps. */
+    std::vector<double> rel_steps; /**< Steps relative to max(|x_i|, 1), empty before the first estimation. */
+
+    /**
+     * @brief Getter for the step of a coordinate at a given point.
+     * @param x Point.
+     * @param i Index of the coordinate.
+     * @return Absolute step of coordinate i.
+     */
+    double step(const std::vector<double>& x, int i) const;
+
+    /**
+     * @brief Central difference of the function along coordinate i.
+     * @param function Pointer to the objective function.
+     * @param x Point.
+     * @param i Index of the coordinate.
+     * @param h Step.
+     * @return Approximation of the partial derivative.
+     */
+    static double central(Function* function, std::vector<double>& x, int i, double h);
+
+    /**
+     * @brief Calculates the gradient with the current steps.
+     * @param function Pointer to the objective function.
+     * @param x Point at which the gradient is calculated.
+     * @param a Area constraint.
+     * @return Gradient vector.
+     */
+    std::vector<double> difference(Function* function, const std::vector<double>& x, const Area& a);
+
+public:
+    /**
+     * @brief Constructor for the finite-difference engine.
+     * @param noise_ Relative noise of the function values; machine precision for exactly computed functions.
+     * @param is_richardson_ If true, central differences are refined by Richardson extrapolation.
+     * @param refresh_interval_ Number of gradients after which the steps are estimated again.
+     */
+    explicit Finite_difference(double noise_ = DBL_EPSILON, bool is_richardson_ = false, int refresh_interval_ = 20);
+
+    /**
+     * @brief Estimates the step of every coordinate at a given point.
+     * Costs 4 * dim evaluations.
+     * @param function Pointer to the objective function.
+     * @param x Point at which the steps are estimated.
+     * @param a Area constraint; coordinates whose probes leave the area keep the default step.
+     */
+    void estimate_steps(Function* function, const std::vector<double>& x, const Area& a);
+
+    /**
+     * @brief Getter for the current steps.
+     * @param x Point at which the steps are used.
+     * @return Absolute step of every coordinate, empty before the first estimation.
+     */
+    std::vector<double> get_steps(const std::vector<double>& x) const;
+
+    /**
+     * @brief Calculates the gradient of the function at a given point.
+     * Near the boundary of the area one-sided differences are used, as in Function::gradient.
+     * @param function Pointer to the objective function.
+     * @param x Point at which the gradient is calculated.
+     * @param a Area constraint.
+     * @return Gradient vector.
+     */
+    std::vector<double> gradient(Function* function, const std::vector<double>& x, const Area& a);
+
+    /**
+     * @brief Calculates the Hessian matrix as the symmetrized difference of gradients.
+     * @param function Pointer to the objective function.
+     * @param x Point at which the Hessian is calculated.
+     * @param a Area constraint.
+     * @return Hessian matrix.
+     */
+    std::vector<std::vector<double>> hessian(Function* function, const std::vector<double>& x, const Area& a);
+};
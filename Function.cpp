@@ -1,10 +1,15 @@
 #include "Function.h"
+#include "Interval.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <stdexcept>
 
-Function::Function() {}
+Function::Function() : num_of_evaluations(0), num_of_single_evaluations(0) {}
 
 Function::~Function() {}
 
-Function::Function(const int dimension) : dim(dimension) {}
+Function::Function(const int dimension) : dim(dimension), num_of_evaluations(0), num_of_single_evaluations(0) {}
 
 int Function::get_dim() {
     return dim;
@@ -18,36 +23,315 @@ double Function::get_f() {
     return f;
 }
 
+long long Function::get_num_of_evaluations() {
+    return num_of_evaluations;
+}
+
+void Function::reset_num_of_evaluations() {
+    num_of_evaluations = 0;
+    num_of_single_evaluations = 0;
+}
+
+double Function::evaluate(const std::vector<double>& x_) {
+    ++num_of_evaluations;
+    return calculate(x_);
+}
+
+float Function::evaluate_single(const std::vector<float>& x_) {
+    ++num_of_evaluations;
+    ++num_of_single_evaluations;
+    return calculate_single(x_);
+}
+
+long long Function::get_num_of_single_evaluations() {
+    return num_of_single_evaluations;
+}
+
+void Function::set_interrupt(std::function<bool()> interrupt_) {
+    interrupt = interrupt_;
+}
+
+bool Function::is_interrupted() const {
+    return interrupt && interrupt();
+}
+
+float Function::calculate_single(const std::vector<float>& x) {
+    return static_cast<float>(calculate(std::vector<double>(x.begin(), x.end())));
+}
+
+void Function::calculate_batch(const double* points, int n, double* values) {
+    std::vector<double> point(dim);
+    for (int k = 0; k < n; ++k) {
+        std::copy(points + k * dim, points + (k + 1) * dim, point.begin());
+        values[k] = calculate(point);
+    }
+}
+
+bool Function::has_interval_extension() const {
+    return false;
+}
+
+Interval Function::calculate_interval(const std::vector<Interval>&) {
+    throw std::logic_error("Function has no interval extension.");
+}
+
+bool Function::has_interval_gradient() const {
+    return false;
+}
+
+Interval Function::calculate_interval_gradient(const std::vector<Interval>&, std::vector<Interval>&) {
+    throw std::logic_error("Function has no interval extension of the gradient.");
+}
+
+Function* Function::clone() const {
+    return nullptr;
+}
+
+void Function::add_num_of_evaluations(long long n) {
+    num_of_evaluations += n;
+}
+
+bool Function::has_analytic_derivatives() const {
+    return false;
+}
+
+
+Residual_function::Residual_function(const int dimension, const int num_of_residuals_)
+    : Function(dimension), num_of_residuals(num_of_residuals_) {}
+
+int Residual_function::get_num_of_residuals() const {
+    return num_of_residuals;
+}
+
+bool Residual_function::has_analytic_jacobian() const {
+    return false;
+}
+
+void Residual_function::jacobian(const double* x_, const double* r, const Area& a, double* j) const {
+    std::vector<double> x_step(x_, x_ + dim), r_step(num_of_residuals);
+    for (int i = 0; i < dim; ++i) {
+        double h = std::sqrt(DBL_EPSILON) * std::max(std::fabs(x_[i]), 1.0);
+        x_step[i] = x_[i] + h;
+        if (!a.is_inside(x_step)) {
+            h = -h;
+            x_step[i] = x_[i] + h;
+        }
+        // The exact distance after rounding makes the difference quotient more accurate.
+        h = x_step[i] - x_[i];
+
+        residuals(x_step.data(), r_step.data());
+        for (int k = 0; k < num_of_residuals; ++k) {
+            j[k * dim + i] = (r_step[k] - r[k]) / h;
+        }
+        x_step[i] = x_[i];
+    }
+}
+
+double Residual_function::evaluate_residuals(const std::vector<double>& x_, std::vector<double>& r) {
+    ++num_of_evaluations;
+    r.resize(num_of_residuals);
+    residuals(x_.data(), r.data());
+    double result = 0;
+    for (double r_k : r) {
+        result += r_k * r_k;
+    }
+    return result;
+}
+
+void Residual_function::evaluate_jacobian(const std::vector<double>& x_, const std::vector<double>& r, const Area& a,
+    std::vector<double>& j) {
+    j.resize(static_cast<size_t>(num_of_residuals) * dim);
+    jacobian(x_.data(), r.data(), a, j.data());
+    if (!has_analytic_jacobian())
+        num_of_evaluations += dim;
+}
+
+double Residual_function::calculate(const std::vector<double>& x_) {
+    std::vector<double> r(num_of_residuals);
+    residuals(x_.data(), r.data());
+    f = 0;
+    for (double r_k : r) {
+        f += r_k * r_k;
+    }
+    return f;
+}
+
 
-Function1::Function1() : Function(2) {}
+Function1::Function1() : Residual_function(2, 2) {}
 
-double Function1::calculate(std::vector<double> x_) {
+Function* Function1::clone() const {
+    return new Function1(*this);
+}
+
+double Function1::calculate(const std::vector<double>& x_) {
     x = x_;
-    f = (x[0] + 2 * x[1] - 7) * (x[0] + 2 * x[1] - 7) + 
-        (2 * x[0] + x[1] - 5) * (2 * x[0] + x[1] - 5);
+    f = value(x.data());
     return f;
 }
 
+float Function1::calculate_single(const std::vector<float>& x_) {
+    return value(x_.data());
+}
+
+bool Function1::has_interval_extension() const {
+    return true;
+}
+
+Interval Function1::calculate_interval(const std::vector<Interval>& x_) {
+    return value(x_.data());
+}
+
+bool Function1::has_interval_gradient() const {
+    return true;
+}
+
+Interval Function1::calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) {
+    Interval_gradient result = value(Interval_gradient::variables(x_).data());
+    g = result.get_gradient(dim);
+    return result.get_value();
+}
+
+template <typename T>
+T Function1::value(const T* x_) const {
+    return sqr(x_[0] + 2 * x_[1] - 7) + sqr(2 * x_[0] + x_[1] - 5);
+}
+
+void Function1::residuals(const double* x_, double* r) const {
+    r[0] = x_[0] + 2 * x_[1] - 7;
+    r[1] = 2 * x_[0] + x_[1] - 5;
+}
+
+bool Function1::has_analytic_jacobian() const {
+    return true;
+}
+
+void Function1::jacobian(const double*, const double*, const Area&, double* j) const {
+    j[0] = 1;
+    j[1] = 2;
+    j[2] = 2;
+    j[3] = 1;
+}
+
+template float Function1::value<float>(const float*) const;
+template double Function1::value<double>(const double*) const;
+template Interval Function1::value<Interval>(const Interval*) const;
+template Interval_gradient Function1::value<Interval_gradient>(const Interval_gradient*) const;
+
 Function2::Function2() : Function(3) {}
 
-double Function2::calculate(std::vector<double> x_) {
+Function* Function2::clone() const {
+    return new Function2(*this);
+}
+
+double Function2::calculate(const std::vector<double>& x_) {
     x = x_;
-    f = x[0] * x[0] + x[1] * x[1] + (1 - x[2]) * (1 - x[2]) + x[0] * x[1];
+    f = value(x.data());
     return f;
 }
 
+float Function2::calculate_single(const std::vector<float>& x_) {
+    return value(x_.data());
+}
+
+bool Function2::has_interval_extension() const {
+    return true;
+}
+
+Interval Function2::calculate_interval(const std::vector<Interval>& x_) {
+    return value(x_.data());
+}
+
+bool Function2::has_interval_gradient() const {
+    return true;
+}
+
+Interval Function2::calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) {
+    Interval_gradient result = value(Interval_gradient::variables(x_).data());
+    g = result.get_gradient(dim);
+    return result.get_value();
+}
+
+template <typename T>
+T Function2::value(const T* x_) const {
+    return sqr(x_[0]) + sqr(x_[1]) + sqr(1 - x_[2]) + x_[0] * x_[1];
+}
+
+template float Function2::value<float>(const float*) const;
+template double Function2::value<double>(const double*) const;
+template Interval Function2::value<Interval>(const Interval*) const;
+template Interval_gradient Function2::value<Interval_gradient>(const Interval_gradient*) const;
+
+
+Function3::Function3() : Residual_function(4, 6) {}
+
+Function3::Function3(const int dimension) : Residual_function(dimension, 2 * (dimension - 1)) {}
 
-Function3::Function3() : Function(4) {}
+Function* Function3::clone() const {
+    return new Function3(*this);
+}
 
-double Function3::calculate(std::vector<double> x_) {
+double Function3::calculate(const std::vector<double>& x_) {
     x = x_;
-    f = 0;
+    f = value(x.data());
+    return f;
+}
+
+float Function3::calculate_single(const std::vector<float>& x_) {
+    return value(x_.data());
+}
+
+bool Function3::has_interval_extension() const {
+    return true;
+}
+
+Interval Function3::calculate_interval(const std::vector<Interval>& x_) {
+    return value(x_.data());
+}
+
+bool Function3::has_interval_gradient() const {
+    return true;
+}
+
+Interval Function3::calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) {
+    Interval_gradient result = value(Interval_gradient::variables(x_).data());
+    g = result.get_gradient(dim);
+    return result.get_value();
+}
+
+template <typename T>
+T Function3::value(const T* x_) const {
+    T result = 0;
     for (int i = 0; i < dim - 1; ++i) {
-        f += 100 * (x[i + 1] - x[i] * x[i]) * (x[i + 1] - x[i] * x[i]) + (x[i] - 1) * (x[i] - 1);
+        result += 100 * sqr(x_[i + 1] - sqr(x_[i])) + sqr(x_[i] - 1);
+    }
+    return result;
+}
+
+void Function3::residuals(const double* x_, double* r) const {
+    for (int i = 0; i < dim - 1; ++i) {
+        r[2 * i] = 10 * (x_[i + 1] - x_[i] * x_[i]);
+        r[2 * i + 1] = x_[i] - 1;
+    }
+}
+
+bool Function3::has_analytic_jacobian() const {
+    return true;
+}
+
+void Function3::jacobian(const double* x_, const double*, const Area&, double* j) const {
+    std::fill(j, j + num_of_residuals * dim, 0.0);
+    for (int i = 0; i < dim - 1; ++i) {
+        j[2 * i * dim + i] = -20 * x_[i];
+        j[2 * i * dim + i + 1] = 10;
+        j[(2 * i + 1) * dim + i] = 1;
     }
-    return f;
 }
 
+template float Function3::value<float>(const float*) const;
+template double Function3::value<double>(const double*) const;
+template Interval Function3::value<Interval>(const Interval*) const;
+template Interval_gradient Function3::value<Interval_gradient>(const Interval_gradient*) const;
+
 
 
 std::vector<double> Function::gradient(std::vector<double> x_, double h, const Area& a) {
@@ -61,14 +345,14 @@ std::vector<double> Function::gradient(std::vector<double> x_, double h, const A
 
         if (a.is_inside(x_upper)) {
             if (a.is_inside(x_lower)) {
-                result[i] = (calculate(x_upper) - calculate(x_lower)) / (2 * h);
+                result[i] = (evaluate(x_upper) - evaluate(x_lower)) / (2 * h);
             }
             else {
-                result[i] = (calculate(x_upper) - calculate(x_)) / h;
+                result[i] = (evaluate(x_upper) - evaluate(x_)) / h;
             }
         }
         else {
-            result[i] = (calculate(x_) - calculate(x_lower)) / h;
+            result[i] = (evaluate(x_) - evaluate(x_lower)) / h;
         }
 
         x_upper[i] = x_[i];
@@ -88,6 +372,8 @@ std::vector<std::vector<double>> Function::hessian(std::vector<double> x_, doubl
     std::vector<double> grad_x_upper = grad_x, grad_x_lower= grad_x;
 
     for (int i = 0; i < dim; ++i) {
+        if (is_interrupted())
+            break;
         x_upper[i] += h;
         x_lower[i] -= h;
 
@@ -117,4 +403,69 @@ std::vector<std::vector<double>> Function::hessian(std::vector<double> x_, doubl
 }
 
 
+std::vector<double> Function::gradient_single(const std::vector<double>& x_, const Area& a) {
+    int dim = get_dim();
+    std::vector<double> result(dim, 0);
+    std::vector<float> x_single(x_.begin(), x_.end());
+    std::vector<double> x_upper = x_, x_lower = x_;
+    double f_x = evaluate_single(x_single);
+
+    for (int i = 0; i < dim; ++i) {
+        double h = std::cbrt(FLT_EPSILON) * std::max(std::fabs(x_[i]), 1.0);
+        x_upper[i] += h;
+        x_lower[i] -= h;
+
+        // The steps are measured after rounding to float, so the differences use the exact distance.
+        float upper = static_cast<float>(x_upper[i]), lower = static_cast<float>(x_lower[i]), center = x_single[i];
+        x_single[i] = upper;
+        double f_upper = a.is_inside(x_upper) ? evaluate_single(x_single) : f_x;
+        x_single[i] = lower;
+        double f_lower = a.is_inside(x_lower) ? evaluate_single(x_single) : f_x;
+        x_single[i] = center;
+
+        if (!a.is_inside(x_upper))
+            upper = center;
+        if (!a.is_inside(x_lower))
+            lower = center;
+        result[i] = (f_upper - f_lower) / (static_cast<double>(upper) - lower);
+
+        x_upper[i] = x_[i];
+        x_lower[i] = x_[i];
+    }
+
+    return result;
+}
+
+std::vector<std::vector<double>> Function::hessian_single(const std::vector<double>& x_, const Area& a) {
+    int dim = get_dim();
+    std::vector<std::vector<double>> result(dim, std::vector<double>(dim, 0));
+    std::vector<double> x_upper = x_, x_lower = x_;
+
+    for (int i = 0; i < dim; ++i) {
+        if (is_interrupted())
+            break;
+        double h = std::cbrt(FLT_EPSILON) * std::max(std::fabs(x_[i]), 1.0);
+        x_upper[i] += h;
+        x_lower[i] -= h;
+        bool is_upper = a.is_inside(x_upper), is_lower = a.is_inside(x_lower);
+
+        std::vector<double> grad_upper = gradient_single(is_upper ? x_upper : x_, a);
+        std::vector<double> grad_lower = gradient_single(is_lower ? x_lower : x_, a);
+        double width = (is_upper ? h : 0) + (is_lower ? h : 0);
+        for (int j = 0; j < dim; ++j) {
+            result[i][j] = width > 0 ? (grad_upper[j] - grad_lower[j]) / width : 0;
+        }
+
+        x_upper[i] = x_[i];
+        x_lower[i] = x_[i];
+    }
+
+    // The difference of gradients is not exactly symmetric.
+    for (int i = 0; i < dim; ++i) {
+        for (int j = 0; j < i; ++j) {
+            result[i][j] = result[j][i] = (result[i][j] + result[j][i]) / 2;
+        }
+    }
 
+    return result;
+}
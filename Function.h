@@ -5,8 +5,11 @@
 #include <random>
 #include <chrono>
 #include <sstream>
+#include <functional>
 #include "Area.h"
 
+class Interval;
+
 /**
  * @brief Base class representing a function.
  */
@@ -15,6 +18,9 @@ protected:
     int dim; /**< Dimension of the function. */
     std::vector<double> x; /**< Vector representing the input variables. */
     double f; /**< Result of the function evaluation. */
+    long long num_of_evaluations; /**< Number of evaluations made through evaluate() and evaluate_single(). */
+    long long num_of_single_evaluations; /**< Number of evaluations made in single precision. */
+    std::function<bool()> interrupt; /**< Returns true when a finite-difference Hessian must stop early, empty if it never must. */
 
 public:
     /**
@@ -51,6 +57,50 @@ public:
      */
     double get_f();
 
+    /**
+     * @brief Getter for the number of evaluations.
+     * @return Number of evaluations made through evaluate().
+     */
+    long long get_num_of_evaluations();
+
+    /**
+     * @brief Resets the number of evaluations to zero.
+     */
+    void reset_num_of_evaluations();
+
+    /**
+     * @brief Calculates the function value at a given point and counts the evaluation.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    double evaluate(const std::vector<double>& x_);
+
+    /**
+     * @brief Calculates the function value in single precision and counts the evaluation.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    float evaluate_single(const std::vector<float>& x_);
+
+    /**
+     * @brief Getter for the number of evaluations made in single precision.
+     * @return Number of single precision evaluations, included in get_num_of_evaluations().
+     */
+    long long get_num_of_single_evaluations();
+
+    /**
+     * @brief Sets the check made between the columns of a finite-difference Hessian.
+     * A Hessian interrupted by it is incomplete and must be discarded.
+     * @param interrupt_ Function returning true when the computation must stop, empty to never stop.
+     */
+    void set_interrupt(std::function<bool()> interrupt_);
+
+    /**
+     * @brief Checks whether a finite-difference Hessian must stop early.
+     * @return True if the interrupt check is set and returns true, false otherwise.
+     */
+    bool is_interrupted() const;
+
     /**
      * @brief Calculates the gradient of the function at a given point.
      * @param x_ Point at which the gradient is calculated.
@@ -58,7 +108,7 @@ public:
      * @param a Area object representing the constraint on the input space.
      * @return Gradient vector.
      */
-    std::vector<double> gradient(std::vector<double> x_, double h, const Area& a);
+    virtual std::vector<double> gradient(std::vector<double> x_, double h, const Area& a);
 
     /**
      * @brief Calculates the Hessian matrix of the function at a given point.
@@ -67,32 +117,261 @@ public:
      * @param a Area object representing the constraint on the input space.
      * @return Hessian matrix.
      */
-    std::vector<std::vector<double>> hessian(std::vector<double> x_, double h, const Area& a);
+    virtual std::vector<std::vector<double>> hessian(std::vector<double> x_, double h, const Area& a);
+
+    /**
+     * @brief Calculates the gradient from single precision evaluations.
+     * The step cbrt(FLT_EPSILON) * max(|x_i|, 1) suits the resolution of single precision.
+     * @param x_ Point at which the gradient is calculated.
+     * @param a Area object representing the constraint on the input space.
+     * @return Gradient vector.
+     */
+    std::vector<double> gradient_single(const std::vector<double>& x_, const Area& a);
+
+    /**
+     * @brief Calculates the Hessian matrix from single precision evaluations.
+     * @param x_ Point at which the Hessian is calculated.
+     * @param a Area object representing the constraint on the input space.
+     * @return Hessian matrix.
+     */
+    std::vector<std::vector<double>> hessian_single(const std::vector<double>& x_, const Area& a);
+
+    /**
+     * @brief Checks whether gradient() and hessian() are computed analytically.
+     * @return True if the derivatives are exact and the step is ignored, false for finite differences.
+     */
+    virtual bool has_analytic_derivatives() const;
 
     /**
      * @brief Pure virtual function for calculating the function value at a given point.
+     * The point is passed by const reference since the library build; overrides that
+     * still take std::vector<double> by value no longer override and must be updated.
+     * @param x Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    virtual double calculate(const std::vector<double>& x) = 0;
+
+    /**
+     * @brief Calculates the function value in single precision.
+     * The default implementation rounds the result of calculate(); functions with a templated
+     * implementation evaluate entirely in float.
      * @param x Point at which the function is evaluated.
      * @return Result of the function evaluation.
      */
-    virtual double calculate(std::vector<double> x) = 0;
+    virtual float calculate_single(const std::vector<float>& x);
+
+    /**
+     * @brief Calculates the function values of n points at once without counting the evaluations.
+     * The default implementation calls calculate() for every point; functions that can evaluate
+     * several points cheaper than one by one override it.
+     * @param points Coordinates, points[k * dim + i] is coordinate i of point k.
+     * @param n Number of points.
+     * @param values Array of n values receiving the function values.
+     */
+    virtual void calculate_batch(const double* points, int n, double* values);
+
+    /**
+     * @brief Checks whether the function can enclose its values over a box, see calculate_interval().
+     * @return True if calculate_interval() is implemented, false otherwise.
+     */
+    virtual bool has_interval_extension() const;
+
+    /**
+     * @brief Calculates an interval containing all function values over a box, rounding errors included.
+     * The default implementation throws std::logic_error.
+     * @param x_ Box, an interval per coordinate.
+     * @return Interval containing the function values.
+     */
+    virtual Interval calculate_interval(const std::vector<Interval>& x_);
+
+    /**
+     * @brief Checks whether the function can enclose its gradient over a box, see calculate_interval_gradient().
+     * @return True if calculate_interval_gradient() is implemented, false otherwise.
+     */
+    virtual bool has_interval_gradient() const;
+
+    /**
+     * @brief Calculates intervals containing all function values and all partial derivatives over a box.
+     * The default implementation throws std::logic_error.
+     * @param x_ Box, an interval per coordinate.
+     * @param g Vector receiving an interval per partial derivative.
+     * @return Interval containing the function values.
+     */
+    virtual Interval calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g);
+
+    /**
+     * @brief Creates an independent copy of the function for use in another thread.
+     * @return Pointer to the copy, or null if the function cannot be copied.
+     */
+    virtual Function* clone() const;
+
+    /**
+     * @brief Adds evaluations made by copies of the function to its counter.
+     * @param n Number of evaluations.
+     */
+    void add_num_of_evaluations(long long n);
+};
+
+/**
+ * @brief Base class representing a sum of squared residuals f(x) = r_1(x)^2 + ... + r_m(x)^2.
+ *
+ * Least-squares methods work with the residual vector r and its Jacobian matrix J instead of the
+ * Hessian matrix: J^T J approximates half of the Hessian near a small residual, and a finite-difference
+ * Jacobian costs dim evaluations of r instead of the 4 * dim^2 of a finite-difference Hessian.
+ */
+class Residual_function : public Function {
+protected:
+    int num_of_residuals; /**< Number of residuals m. */
+
+public:
+    /**
+     * @brief Constructor initializing the function with a specified dimension and number of residuals.
+     * @param dimension Dimension of the function.
+     * @param num_of_residuals_ Number of residuals.
+     */
+    Residual_function(const int dimension, const int num_of_residuals_);
+
+    /**
+     * @brief Getter for the number of residuals.
+     * @return Number of residuals m.
+     */
+    int get_num_of_residuals() const;
+
+    /**
+     * @brief Pure virtual function calculating the residuals at a given point.
+     * @param x_ Array of dim coordinates.
+     * @param r Array of m values receiving the residuals.
+     */
+    virtual void residuals(const double* x_, double* r) const = 0;
+
+    /**
+     * @brief Checks whether jacobian() is computed analytically.
+     * @return True if the Jacobian matrix is exact, false for finite differences.
+     */
+    virtual bool has_analytic_jacobian() const;
+
+    /**
+     * @brief Calculates the Jacobian matrix of the residuals.
+     * The default implementation uses forward differences with the step sqrt(DBL_EPSILON) * max(|x_i|, 1),
+     * taken backward where the forward point leaves the area.
+     * @param x_ Array of dim coordinates.
+     * @param r Residuals at x_.
+     * @param a Area object representing the constraint on the input space.
+     * @param j Array of m * dim values receiving the matrix, j[k * dim + i] is the derivative of r_k by x_i.
+     */
+    virtual void jacobian(const double* x_, const double* r, const Area& a, double* j) const;
+
+    /**
+     * @brief Calculates the residuals and counts one evaluation.
+     * @param x_ Point at which the residuals are calculated.
+     * @param r Vector receiving the m residuals.
+     * @return Function value, the sum of the squared residuals.
+     */
+    double evaluate_residuals(const std::vector<double>& x_, std::vector<double>& r);
+
+    /**
+     * @brief Calculates the Jacobian matrix and counts dim evaluations if it is not analytic.
+     * @param x_ Point at which the matrix is calculated.
+     * @param r Residuals at x_.
+     * @param a Area object representing the constraint on the input space.
+     * @param j Vector receiving the m * dim values of the matrix.
+     */
+    void evaluate_jacobian(const std::vector<double>& x_, const std::vector<double>& r, const Area& a, std::vector<double>& j);
+
+    /**
+     * @brief Calculates the function value as the sum of the squared residuals.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    double calculate(const std::vector<double>& x_) override;
 };
 
 /**
  * @brief Derived class representing the first function: Booth Function.
  */
-class Function1 : public Function {
+class Function1 : public Residual_function {
 public:
     /**
      * @brief Default constructor initializing the function with dimension 2.
      */
     Function1();
 
+    /**
+     * @brief Creates a copy of the function.
+     * @return Pointer to the copy.
+     */
+    Function* clone() const override;
+
     /**
      * @brief Calculates the function value for the first function.
      * @param x_ Point at which the function is evaluated.
      * @return Result of the function evaluation.
      */
-    double calculate(std::vector<double> x_) override;
+    double calculate(const std::vector<double>& x_) override;
+
+    /**
+     * @brief Calculates the function value for the first function in single precision.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    float calculate_single(const std::vector<float>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension.
+     * @return True.
+     */
+    bool has_interval_extension() const override;
+
+    /**
+     * @brief Calculates an enclosure of the function values over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval(const std::vector<Interval>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension of the gradient.
+     * @return True.
+     */
+    bool has_interval_gradient() const override;
+
+    /**
+     * @brief Calculates enclosures of the function values and of the gradient over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @param g Vector receiving an interval per partial derivative.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) override;
+
+    /**
+     * @brief Calculates the residuals x_1 + 2 * x_2 - 7 and 2 * x_1 + x_2 - 5.
+     * @param x_ Array of dim coordinates.
+     * @param r Array of m values receiving the residuals.
+     */
+    void residuals(const double* x_, double* r) const override;
+
+    /**
+     * @brief Checks whether jacobian() is computed analytically.
+     * @return True.
+     */
+    bool has_analytic_jacobian() const override;
+
+    /**
+     * @brief Calculates the Jacobian matrix of the residuals analytically.
+     * @param x_ Array of dim coordinates.
+     * @param r Residuals at x_, unused.
+     * @param a Area object, unused.
+     * @param j Array of m * dim values receiving the matrix.
+     */
+    void jacobian(const double* x_, const double* r, const Area& a, double* j) const override;
+
+    /**
+     * @brief Calculates the function value in the precision of T.
+     * @param x_ Array of dim coordinates.
+     * @return Result of the function evaluation.
+     */
+    template <typename T>
+    T value(const T* x_) const;
 };
 
 /**
@@ -105,28 +384,152 @@ public:
      */
     Function2();
 
+    /**
+     * @brief Creates a copy of the function.
+     * @return Pointer to the copy.
+     */
+    Function* clone() const override;
+
     /**
      * @brief Calculates the function value for the second function.
      * @param x_ Point at which the function is evaluated.
      * @return Result of the function evaluation.
      */
-    double calculate(std::vector<double> x_) override;
+    double calculate(const std::vector<double>& x_) override;
+
+    /**
+     * @brief Calculates the function value for the second function in single precision.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    float calculate_single(const std::vector<float>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension.
+     * @return True.
+     */
+    bool has_interval_extension() const override;
+
+    /**
+     * @brief Calculates an enclosure of the function values over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval(const std::vector<Interval>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension of the gradient.
+     * @return True.
+     */
+    bool has_interval_gradient() const override;
+
+    /**
+     * @brief Calculates enclosures of the function values and of the gradient over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @param g Vector receiving an interval per partial derivative.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) override;
+
+    /**
+     * @brief Calculates the function value in the precision of T.
+     * @param x_ Array of dim coordinates.
+     * @return Result of the function evaluation.
+     */
+    template <typename T>
+    T value(const T* x_) const;
 };
 
 /**
  * @brief Derived class representing the third function: Rosenbrock Function.
  */
-class Function3 : public Function {
+class Function3 : public Residual_function {
 public:
     /**
      * @brief Default constructor initializing the function with dimension 4.
      */
     Function3();
 
+    /**
+     * @brief Constructor for the generalized Rosenbrock function of a given dimension.
+     * @param dimension Dimension of the function, at least 2.
+     */
+    explicit Function3(const int dimension);
+
+    /**
+     * @brief Creates a copy of the function.
+     * @return Pointer to the copy.
+     */
+    Function* clone() const override;
+
     /**
      * @brief Calculates the function value for the third function.
      * @param x_ Point at which the function is evaluated.
      * @return Result of the function evaluation.
      */
-    double calculate(std::vector<double> x_) override;
+    double calculate(const std::vector<double>& x_) override;
+
+    /**
+     * @brief Calculates the function value for the third function in single precision.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    float calculate_single(const std::vector<float>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension.
+     * @return True.
+     */
+    bool has_interval_extension() const override;
+
+    /**
+     * @brief Calculates an enclosure of the function values over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval(const std::vector<Interval>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension of the gradient.
+     * @return True.
+     */
+    bool has_interval_gradient() const override;
+
+    /**
+     * @brief Calculates enclosures of the function values and of the gradient over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @param g Vector receiving an interval per partial derivative.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) override;
+
+    /**
+     * @brief Calculates the residuals 10 * (x_{i+1} - x_i^2) and x_i - 1.
+     * @param x_ Array of dim coordinates.
+     * @param r Array of m values receiving the residuals.
+     */
+    void residuals(const double* x_, double* r) const override;
+
+    /**
+     * @brief Checks whether jacobian() is computed analytically.
+     * @return True.
+     */
+    bool has_analytic_jacobian() const override;
+
+    /**
+     * @brief Calculates the Jacobian matrix of the residuals analytically.
+     * @param x_ Array of dim coordinates.
+     * @param r Residuals at x_, unused.
+     * @param a Area object, unused.
+     * @param j Array of m * dim values receiving the matrix.
+     */
+    void jacobian(const double* x_, const double* r, const Area& a, double* j) const override;
+
+    /**
+     * @brief Calculates the function value in the precision of T.
+     * @param x_ Array of dim coordinates.
+     * @return Result of the function evaluation.
+     */
+    template <typename T>
+    T value(const T* x_) const;
 };
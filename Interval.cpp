@@ -0,0 +1,279 @@
+#include "Interval.h"
+#include <cfloat>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    const double pi = 3.14159265358979323846;
+
+    /**
+     * @brief Widens bounds computed by the elementary functions, which are accurate to about one ulp, by two ulps.
+     */
+    Interval outward_elementary(double lower, double upper) {
+        Interval a = Interval::outward(lower, upper);
+        return Interval::outward(a.get_lower(), a.get_upper());
+    }
+
+    /**
+     * @brief Checks whether [a; b] may contain a point offset + 2 * pi * k. The margin covers the rounding
+     * of the multiples of pi, so the answer errs on the side of yes.
+     */
+    bool may_contain_period_point(double a, double b, double offset) {
+        double margin = 8 * DBL_EPSILON * std::max(std::max(std::fabs(a), std::fabs(b)), 1.0);
+        double k = std::ceil((a - margin - offset) / (2 * pi));
+        return offset + k * 2 * pi <= b + margin;
+    }
+}
+
+Interval pow(const Interval& a, int n) {
+    if (n == 0)
+        return Interval(1);
+    if (n == 1)
+        return a;
+    if (n % 2 == 0) {
+        Interval s = sqr(a);
+        Interval result = s;
+        for (int i = 1; i < n / 2; ++i) {
+            result *= s;
+        }
+        return result;
+    }
+    // Odd powers are increasing: the bounds are the powers of the bounds.
+    Interval lower = a.get_lower(), upper = a.get_upper();
+    for (int i = 1; i < n; ++i) {
+        lower *= a.get_lower();
+        upper *= a.get_upper();
+    }
+    return Interval(lower.get_lower(), upper.get_upper());
+}
+
+Interval abs(const Interval& a) {
+    if (a.get_lower() >= 0)
+        return a;
+    if (a.get_upper() <= 0)
+        return -a;
+    return Interval(0, std::max(-a.get_lower(), a.get_upper()));
+}
+
+Interval sqrt(const Interval& a) {
+    if (a.get_upper() < 0)
+        return Interval(NAN, NAN);
+    Interval result = Interval::outward(std::sqrt(std::max(a.get_lower(), 0.0)), std::sqrt(a.get_upper()));
+    return Interval(std::max(result.get_lower(), 0.0), result.get_upper());
+}
+
+Interval exp(const Interval& a) {
+    Interval result = outward_elementary(std::exp(a.get_lower()), std::exp(a.get_upper()));
+    return Interval(std::max(result.get_lower(), 0.0), result.get_upper());
+}
+
+Interval log(const Interval& a) {
+    if (a.get_upper() <= 0)
+        return Interval(NAN, NAN);
+    double lower = a.get_lower() > 0 ? std::log(a.get_lower()) : -INFINITY;
+    return outward_elementary(lower, std::log(a.get_upper()));
+}
+
+Interval cos(const Interval& a) {
+    if (!std::isfinite(a.get_lower()) || !std::isfinite(a.get_upper()) || a.width() >= 2 * pi)
+        return Interval(-1, 1);
+
+    double c_lower = std::cos(a.get_lower()), c_upper = std::cos(a.get_upper());
+    double lower = std::min(c_lower, c_upper), upper = std::max(c_lower, c_upper);
+    if (may_contain_period_point(a.get_lower(), a.get_upper(), 0))
+        upper = 1;
+    if (may_contain_period_point(a.get_lower(), a.get_upper(), pi))
+        lower = -1;
+    Interval result = outward_elementary(lower, upper);
+    return Interval(std::max(result.get_lower(), -1.0), std::min(result.get_upper(), 1.0));
+}
+
+Interval sin(const Interval& a) {
+    if (!std::isfinite(a.get_lower()) || !std::isfinite(a.get_upper()) || a.width() >= 2 * pi)
+        return Interval(-1, 1);
+
+    double s_lower = std::sin(a.get_lower()), s_upper = std::sin(a.get_upper());
+    double lower = std::min(s_lower, s_upper), upper = std::max(s_lower, s_upper);
+    if (may_contain_period_point(a.get_lower(), a.get_upper(), pi / 2))
+        upper = 1;
+    if (may_contain_period_point(a.get_lower(), a.get_upper(), -pi / 2))
+        lower = -1;
+    Interval result = outward_elementary(lower, upper);
+    return Interval(std::max(result.get_lower(), -1.0), std::min(result.get_upper(), 1.0));
+}
+
+std::ostream& operator<<(std::ostream& out, const Interval& a) {
+    return out << "[" << a.get_lower() << "; " << a.get_upper() << "]";
+}
+
+
+Interval_gradient::Interval_gradient() {}
+
+Interval_gradient::Interval_gradient(double value_) : value(value_) {}
+
+Interval_gradient::Interval_gradient(const Interval& value_) : value(value_) {}
+
+Interval_gradient::Interval_gradient(const Interval& value_, std::vector<Interval> gradient_) : value(value_), gradient(std::move(gradient_)) {}
+
+std::vector<Interval_gradient> Interval_gradient::variables(const std::vector<Interval>& x_) {
+    int dim = static_cast<int>(x_.size());
+    std::vector<Interval_gradient> result;
+    result.reserve(dim);
+    for (int i = 0; i < dim; ++i) {
+        std::vector<Interval> unit(dim);
+        unit[i] = 1;
+        result.emplace_back(x_[i], std::move(unit));
+    }
+    return result;
+}
+
+const Interval& Interval_gradient::get_value() const {
+    return value;
+}
+
+const std::vector<Interval>& Interval_gradient::get_gradient() const {
+    return gradient;
+}
+
+std::vector<Interval> Interval_gradient::get_gradient(int dim) const {
+    return gradient.empty() ? std::vector<Interval>(dim) : gradient;
+}
+
+Interval_gradient& Interval_gradient::operator+=(const Interval_gradient& other) {
+    return *this = *this + other;
+}
+
+Interval_gradient& Interval_gradient::operator-=(const Interval_gradient& other) {
+    return *this = *this - other;
+}
+
+Interval_gradient& Interval_gradient::operator*=(const Interval_gradient& other) {
+    return *this = *this * other;
+}
+
+Interval_gradient& Interval_gradient::operator/=(const Interval_gradient& other) {
+    return *this = *this / other;
+}
+
+namespace {
+    /**
+     * @brief Applies the chain rule: the gradient of a function with the derivative d of its argument a.
+     */
+    Interval_gradient chain(const Interval& value, const Interval& d, const Interval_gradient& a) {
+        std::vector<Interval> gradient(a.get_gradient().size());
+        for (size_t i = 0; i < gradient.size(); ++i) {
+            gradient[i] = d * a.get_gradient()[i];
+        }
+        return Interval_gradient(value, std::move(gradient));
+    }
+
+    /**
+     * @brief Combines the gradients of a and b as c_a * grad a + c_b * grad b, where an empty gradient is zero.
+     */
+    Interval_gradient combine(const Interval& value, const Interval& c_a, const Interval_gradient& a, const Interval& c_b, const Interval_gradient& b) {
+        if (a.get_gradient().empty())
+            return chain(value, c_b, b);
+        if (b.get_gradient().empty())
+            return chain(value, c_a, a);
+        std::vector<Interval> gradient(a.get_gradient().size());
+        for (size_t i = 0; i < gradient.size(); ++i) {
+            gradient[i] = c_a * a.get_gradient()[i] + c_b * b.get_gradient()[i];
+        }
+        return Interval_gradient(value, std::move(gradient));
+    }
+}
+
+Interval_gradient operator+(const Interval_gradient& a, const Interval_gradient& b) {
+    return combine(a.get_value() + b.get_value(), 1, a, 1, b);
+}
+
+Interval_gradient operator-(const Interval_gradient& a, const Interval_gradient& b) {
+    return combine(a.get_value() - b.get_value(), 1, a, -1, b);
+}
+
+Interval_gradient operator-(const Interval_gradient& a) {
+    return chain(-a.get_value(), -1, a);
+}
+
+Interval_gradient operator*(const Interval_gradient& a, const Interval_gradient& b) {
+    return combine(a.get_value() * b.get_value(), b.get_value(), a, a.get_value(), b);
+}
+
+Interval_gradient operator/(const Interval_gradient& a, const Interval_gradient& b) {
+    Interval value = a.get_value() / b.get_value();
+    // (a / b)' = (a' - (a / b) * b') / b
+    Interval reciprocal = 1 / b.get_value();
+    return combine(value, reciprocal, a, -value * reciprocal, b);
+}
+
+Interval_gradient sqr(const Interval_gradient& a) {
+    return chain(sqr(a.get_value()), 2 * a.get_value(), a);
+}
+
+Interval_gradient pow(const Interval_gradient& a, int n) {
+    if (n == 0)
+        return Interval_gradient(1);
+    return chain(pow(a.get_value(), n), n * pow(a.get_value(), n - 1), a);
+}
+
+Interval_gradient abs(const Interval_gradient& a) {
+    Interval sign = a.get_value().get_lower() >= 0 ? Interval(1) : a.get_value().get_upper() <= 0 ? Interval(-1) : Interval(-1, 1);
+    return chain(abs(a.get_value()), sign, a);
+}
+
+Interval_gradient sqrt(const Interval_gradient& a) {
+    Interval value = sqrt(a.get_value());
+    return chain(value, 1 / (2 * value), a);
+}
+
+Interval_gradient exp(const Interval_gradient& a) {
+    Interval value = exp(a.get_value());
+    return chain(value, value, a);
+}
+
+Interval_gradient log(const Interval_gradient& a) {
+    return chain(log(a.get_value()), 1 / a.get_value(), a);
+}
+
+Interval_gradient sin(const Interval_gradient& a) {
+    return chain(sin(a.get_value()), cos(a.get_value()), a);
+}
+
+Interval_gradient cos(const Interval_gradient& a) {
+    return chain(cos(a.get_value()), -sin(a.get_value()), a);
+}
+
+
+Expression_function::Expression_function(int dimension, Point_expression point_expression_, Interval_expression interval_expression_,
+    Gradient_expression gradient_expression_) : Function(dimension), point_expression(point_expression_),
+    interval_expression(interval_expression_), gradient_expression(gradient_expression_) {}
+
+Function* Expression_function::clone() const {
+    return new Expression_function(*this);
+}
+
+double Expression_function::calculate(const std::vector<double>& x_) {
+    x = x_;
+    f = point_expression(x.data());
+    return f;
+}
+
+bool Expression_function::has_interval_extension() const {
+    return true;
+}
+
+Interval Expression_function::calculate_interval(const std::vector<Interval>& x_) {
+    return interval_expression(x_.data());
+}
+
+bool Expression_function::has_interval_gradient() const {
+    return static_cast<bool>(gradient_expression);
+}
+
+Interval Expression_function::calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) {
+    if (!gradient_expression)
+        throw std::logic_error("Function has no interval extension of the gradient.");
+    Interval_gradient result = gradient_expression(Interval_gradient::variables(x_).data());
+    g = result.get_gradient(dim);
+    return result.get_value();
+}
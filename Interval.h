@@ -0,0 +1,400 @@
+#pragma once
+
+#include "Function.h"
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * @brief Closed interval of real numbers with outward-rounded arithmetic.
+ *
+ * Every operation widens its result by one unit in the last place in each direction (two for the
+ * elementary functions), so the interval computed for an expression over a box is guaranteed to
+ * contain every value the expression takes in the box, rounding errors included. The arithmetic
+ * operators are defined in the header, as branch-and-bound evaluates them millions of times.
+ */
+class Interval {
+private:
+    double lower; /**< Lower bound. */
+    double upper; /**< Upper bound. */
+
+public:
+    /**
+     * @brief Default constructor. The interval [0; 0].
+     */
+    Interval() : lower(0), upper(0) {}
+
+    /**
+     * @brief Constructor for the degenerate interval of a number, also used to convert constants in expressions.
+     * @param value Number.
+     */
+    Interval(double value) : lower(value), upper(value) {}
+
+    /**
+     * @brief Constructor for the interval [lower_; upper_].
+     * @param lower_ Lower bound.
+     * @param upper_ Upper bound, not less than the lower one.
+     */
+    Interval(double lower_, double upper_) : lower(lower_), upper(upper_) {}
+
+    /**
+     * @brief Getter for the lower bound.
+     * @return Lower bound.
+     */
+    double get_lower() const {
+        return lower;
+    }
+
+    /**
+     * @brief Getter for the upper bound.
+     * @return Upper bound.
+     */
+    double get_upper() const {
+        return upper;
+    }
+
+    /**
+     * @brief Getter for the width.
+     * @return Upper bound minus the lower one.
+     */
+    double width() const {
+        return upper - lower;
+    }
+
+    /**
+     * @brief Getter for the midpoint.
+     * @return Midpoint of the interval.
+     */
+    double midpoint() const {
+        return lower + 0.5 * (upper - lower);
+    }
+
+    /**
+     * @brief Checks whether the interval contains a number.
+     * @param value Number.
+     * @return True if lower <= value <= upper.
+     */
+    bool contains(double value) const {
+        return lower <= value && value <= upper;
+    }
+
+    /**
+     * @brief Creates an interval from bounds computed in round-to-nearest, widening each by one ulp.
+     * @param lower_ Rounded lower bound.
+     * @param upper_ Rounded upper bound.
+     * @return Interval containing the exact result.
+     */
+    static Interval outward(double lower_, double upper_) {
+        return Interval(std::nextafter(lower_, -INFINITY), std::nextafter(upper_, INFINITY));
+    }
+
+    Interval& operator+=(const Interval& other);
+    Interval& operator-=(const Interval& other);
+    Interval& operator*=(const Interval& other);
+    Interval& operator/=(const Interval& other);
+};
+
+inline Interval operator+(const Interval& a, const Interval& b) {
+    return Interval::outward(a.get_lower() + b.get_lower(), a.get_upper() + b.get_upper());
+}
+
+inline Interval operator-(const Interval& a, const Interval& b) {
+    return Interval::outward(a.get_lower() - b.get_upper(), a.get_upper() - b.get_lower());
+}
+
+inline Interval operator-(const Interval& a) {
+    return Interval(-a.get_upper(), -a.get_lower());
+}
+
+inline Interval operator*(const Interval& a, const Interval& b) {
+    double p1 = a.get_lower() * b.get_lower(), p2 = a.get_lower() * b.get_upper();
+    double p3 = a.get_upper() * b.get_lower(), p4 = a.get_upper() * b.get_upper();
+    // 0 * inf gives NaN, which min and max would drop or keep depending on its position.
+    if (std::isnan(p1) || std::isnan(p2) || std::isnan(p3) || std::isnan(p4))
+        return Interval(-INFINITY, INFINITY);
+    return Interval::outward(std::min(std::min(p1, p2), std::min(p3, p4)), std::max(std::max(p1, p2), std::max(p3, p4)));
+}
+
+inline Interval operator/(const Interval& a, const Interval& b) {
+    if (b.contains(0))
+        return Interval(-INFINITY, INFINITY);
+    double q1 = a.get_lower() / b.get_lower(), q2 = a.get_lower() / b.get_upper();
+    double q3 = a.get_upper() / b.get_lower(), q4 = a.get_upper() / b.get_upper();
+    return Interval::outward(std::min(std::min(q1, q2), std::min(q3, q4)), std::max(std::max(q1, q2), std::max(q3, q4)));
+}
+
+inline Interval& Interval::operator+=(const Interval& other) {
+    return *this = *this + other;
+}
+
+inline Interval& Interval::operator-=(const Interval& other) {
+    return *this = *this - other;
+}
+
+inline Interval& Interval::operator*=(const Interval& other) {
+    return *this = *this * other;
+}
+
+inline Interval& Interval::operator/=(const Interval& other) {
+    return *this = *this / other;
+}
+
+/**
+ * @brief Square of an interval. Tighter than a * a, which treats the two factors as independent.
+ * @param a Interval.
+ * @return Enclosure of {t^2 : t in a}.
+ */
+inline Interval sqr(const Interval& a) {
+    double l = a.get_lower() * a.get_lower(), u = a.get_upper() * a.get_upper();
+    if (a.contains(0))
+        return Interval(0, std::nextafter(std::max(l, u), INFINITY));
+    return Interval::outward(std::min(l, u), std::max(l, u));
+}
+
+/**
+ * @brief Square of a number, the counterpart of sqr(Interval) for expressions written for both types.
+ * @param a Number.
+ * @return a * a.
+ */
+inline double sqr(double a) {
+    return a * a;
+}
+
+/**
+ * @brief Square of a number in single precision.
+ * @param a Number.
+ * @return a * a.
+ */
+inline float sqr(float a) {
+    return a * a;
+}
+
+/**
+ * @brief Integer power of an interval.
+ * @param a Interval.
+ * @param n Non-negative exponent.
+ * @return Enclosure of {t^n : t in a}.
+ */
+Interval pow(const Interval& a, int n);
+
+/**
+ * @brief Absolute value of an interval.
+ * @param a Interval.
+ * @return Enclosure of {|t| : t in a}.
+ */
+Interval abs(const Interval& a);
+
+/**
+ * @brief Square root of an interval. Negative parts of the interval are ignored.
+ * @param a Interval.
+ * @return Enclosure of {sqrt(t) : t in a, t >= 0}.
+ */
+Interval sqrt(const Interval& a);
+
+/**
+ * @brief Exponential of an interval.
+ * @param a Interval.
+ * @return Enclosure of {e^t : t in a}.
+ */
+Interval exp(const Interval& a);
+
+/**
+ * @brief Natural logarithm of an interval. Non-positive parts of the interval give -infinity.
+ * @param a Interval.
+ * @return Enclosure of {ln t : t in a, t > 0}.
+ */
+Interval log(const Interval& a);
+
+/**
+ * @brief Sine of an interval.
+ * @param a Interval.
+ * @return Enclosure of {sin t : t in a}.
+ */
+Interval sin(const Interval& a);
+
+/**
+ * @brief Cosine of an interval.
+ * @param a Interval.
+ * @return Enclosure of {cos t : t in a}.
+ */
+Interval cos(const Interval& a);
+
+/**
+ * @brief Writes an interval as [lower; upper].
+ * @param out Output stream.
+ * @param a Interval.
+ * @return Output stream.
+ */
+std::ostream& operator<<(std::ostream& out, const Interval& a);
+
+/**
+ * @brief Interval together with enclosures of its partial derivatives by the coordinates of a box.
+ *
+ * Evaluating an expression on the variables() of a box gives an enclosure of the function and of its
+ * gradient over the box by forward differentiation. Constants carry an empty gradient, which stands for
+ * zeros, so they cost no more than with Interval.
+ */
+class Interval_gradient {
+private:
+    Interval value; /**< Enclosure of the values. */
+    std::vector<Interval> gradient; /**< Enclosures of the partial derivatives, empty for a constant. */
+
+public:
+    /**
+     * @brief Default constructor. The constant 0.
+     */
+    Interval_gradient();
+
+    /**
+     * @brief Constructor for a constant, also used to convert constants in expressions.
+     * @param value_ Number.
+     */
+    Interval_gradient(double value_);
+
+    /**
+     * @brief Constructor for a constant interval.
+     * @param value_ Interval.
+     */
+    Interval_gradient(const Interval& value_);
+
+    /**
+     * @brief Constructor for an interval with given derivatives.
+     * @param value_ Enclosure of the values.
+     * @param gradient_ Enclosures of the partial derivatives.
+     */
+    Interval_gradient(const Interval& value_, std::vector<Interval> gradient_);
+
+    /**
+     * @brief Creates the coordinates of a box as independent variables.
+     * @param x_ Box, an interval per coordinate.
+     * @return Variable i has the value x_[i] and the unit gradient e_i.
+     */
+    static std::vector<Interval_gradient> variables(const std::vector<Interval>& x_);
+
+    /**
+     * @brief Getter for the enclosure of the values.
+     * @return Interval containing the values.
+     */
+    const Interval& get_value() const;
+
+    /**
+     * @brief Getter for the enclosures of the partial derivatives.
+     * @return Enclosures, empty for a constant.
+     */
+    const std::vector<Interval>& get_gradient() const;
+
+    /**
+     * @brief Getter for the enclosures of the partial derivatives of a given dimension.
+     * @param dim Dimension of the box.
+     * @return Enclosures of the dim partial derivatives.
+     */
+    std::vector<Interval> get_gradient(int dim) const;
+
+    Interval_gradient& operator+=(const Interval_gradient& other);
+    Interval_gradient& operator-=(const Interval_gradient& other);
+    Interval_gradient& operator*=(const Interval_gradient& other);
+    Interval_gradient& operator/=(const Interval_gradient& other);
+};
+
+Interval_gradient operator+(const Interval_gradient& a, const Interval_gradient& b);
+Interval_gradient operator-(const Interval_gradient& a, const Interval_gradient& b);
+Interval_gradient operator-(const Interval_gradient& a);
+Interval_gradient operator*(const Interval_gradient& a, const Interval_gradient& b);
+Interval_gradient operator/(const Interval_gradient& a, const Interval_gradient& b);
+Interval_gradient sqr(const Interval_gradient& a);
+Interval_gradient pow(const Interval_gradient& a, int n);
+Interval_gradient abs(const Interval_gradient& a);
+Interval_gradient sqrt(const Interval_gradient& a);
+Interval_gradient exp(const Interval_gradient& a);
+Interval_gradient log(const Interval_gradient& a);
+Interval_gradient sin(const Interval_gradient& a);
+Interval_gradient cos(const Interval_gradient& a);
+
+/**
+ * @brief Function given by an expression that can be evaluated both at points and over boxes.
+ *
+ * The expression is written once as a generic callable taking an array of coordinates, e.g.
+ * [](const auto* x) { return sqr(x[0] - 1) + sin(x[1]) * x[0]; }. The elementary functions are found by
+ * argument-dependent lookup for Interval; for double they must be visible unqualified, e.g. with
+ * using std::abs, as the C abs(int) would otherwise truncate. create() instantiates the expression for
+ * double, Interval and Interval_gradient, so the function gets interval extensions of itself and of its
+ * gradient for free.
+ */
+class Expression_function : public Function {
+public:
+    typedef std::function<double(const double*)> Point_expression; /**< Expression evaluated at a point. */
+    typedef std::function<Interval(const Interval*)> Interval_expression; /**< Expression evaluated over a box. */
+    typedef std::function<Interval_gradient(const Interval_gradient*)> Gradient_expression; /**< Expression differentiated over a box. */
+
+private:
+    Point_expression point_expression; /**< Expression for points. */
+    Interval_expression interval_expression; /**< Expression for boxes. */
+    Gradient_expression gradient_expression; /**< Expression for boxes with derivatives, may be empty. */
+
+public:
+    /**
+     * @brief Constructor for the function of two forms of the same expression.
+     * @param dimension Dimension of the function.
+     * @param point_expression_ Expression for points.
+     * @param interval_expression_ Expression for boxes, enclosing the values of the point expression.
+     * @param gradient_expression_ Expression for boxes with derivatives, or empty if there is none.
+     */
+    Expression_function(int dimension, Point_expression point_expression_, Interval_expression interval_expression_,
+        Gradient_expression gradient_expression_ = Gradient_expression());
+
+    /**
+     * @brief Creates the function of a generic expression.
+     * @param dimension Dimension of the function.
+     * @param expression Callable accepting const double*, const Interval* and const Interval_gradient*.
+     * @return Pointer to the new function.
+     */
+    template <typename Expression>
+    static Expression_function* create(int dimension, Expression expression) {
+        return new Expression_function(dimension,
+            [expression](const double* x_) { return static_cast<double>(expression(x_)); },
+            [expression](const Interval* x_) { return Interval(expression(x_)); },
+            [expression](const Interval_gradient* x_) { return Interval_gradient(expression(x_)); });
+    }
+
+    /**
+     * @brief Creates a copy of the function.
+     * @return Pointer to the copy.
+     */
+    Function* clone() const override;
+
+    /**
+     * @brief Calculates the function value.
+     * @param x_ Point at which the function is evaluated.
+     * @return Result of the function evaluation.
+     */
+    double calculate(const std::vector<double>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension.
+     * @return True.
+     */
+    bool has_interval_extension() const override;
+
+    /**
+     * @brief Calculates an enclosure of the function values over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval(const std::vector<Interval>& x_) override;
+
+    /**
+     * @brief Checks whether the function has an interval extension of the gradient.
+     * @return True if the gradient expression is set.
+     */
+    bool has_interval_gradient() const override;
+
+    /**
+     * @brief Calculates enclosures of the function values and of the gradient over a box.
+     * @param x_ Box, an interval per coordinate.
+     * @param g Vector receiving an interval per partial derivative.
+     * @return Interval containing the function values.
+     */
+    Interval calculate_interval_gradient(const std::vector<Interval>& x_, std::vector<Interval>& g) override;
+};
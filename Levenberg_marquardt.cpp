@@ -0,0 +1,128 @@
+#include "Levenberg_marquardt.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+Levenberg_marquardt::Levenberg_marquardt(Residual_function* function, std::vector<double> x_0, Area area,
+    Stop_criterion* stop_criterion, double damping_factor_)
+    : Optimization_method(function, x_0, area, stop_criterion), residual_function(function), damping_factor(damping_factor_),
+    lambda(0), nu(2), num_of_rejections(0) {}
+
+double Levenberg_marquardt::get_lambda() {
+    return lambda;
+}
+
+int Levenberg_marquardt::get_num_of_rejections() {
+    return num_of_rejections;
+}
+
+void Levenberg_marquardt::optimization() {
+    int dim = function->get_dim();
+    int m = residual_function->get_num_of_residuals();
+    bool is_started = is_resumed;
+    is_resumed = false;
+
+    std::vector<double> r, j, new_r;
+    Eigen::MatrixXd jtj(dim, dim);
+    Eigen::VectorXd jtr(dim);
+
+    // Linearizes the residuals at the current point and hands the gradient to the stopping criterion.
+    auto linearize = [&]() {
+        const std::vector<double>& x = seq_x_i.back();
+        residual_function->evaluate_residuals(x, r);
+        residual_function->evaluate_jacobian(x, r, area, j);
+        Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> jacobian(j.data(), m, dim);
+        Eigen::Map<const Eigen::VectorXd> residuals(r.data(), m);
+        jtj = jacobian.transpose() * jacobian;
+        jtr = jacobian.transpose() * residuals;
+
+        grad_point = x;
+        grad_value.resize(dim);
+        for (int i = 0; i < dim; ++i) {
+            grad_value[i] = 2 * jtr(i);
+        }
+    };
+
+    linearize();
+    if (!is_started) {
+        lambda = damping_factor * std::max(jtj.diagonal().maxCoeff(), DBL_MIN);
+        nu = 2;
+    }
+
+    while (!is_finished()) {
+        TRACE_SCOPE("iteration");
+        // Non-finite residuals or a damping grown to infinity leave nothing to solve; rejections alone would never end.
+        if (!std::isfinite(lambda) || !jtr.allFinite() || !jtj.allFinite())
+            break;
+        // Marquardt's scaling makes the step invariant to the units of the coordinates.
+        Eigen::VectorXd scale = jtj.diagonal().cwiseMax(DBL_EPSILON * std::max(jtj.diagonal().maxCoeff(), 1.0));
+        Eigen::MatrixXd damped = jtj;
+        damped.diagonal() += lambda * scale;
+
+        Eigen::LDLT<Eigen::MatrixXd> solver(damped);
+        Eigen::VectorXd step = solver.solve(-jtr);
+        if (solver.info() != Eigen::Success || !step.allFinite()) {
+            lambda *= nu;
+            nu *= 2;
+            ++num_of_rejections;
+            continue;
+        }
+
+        std::vector<double> new_x = seq_x_i.back();
+        double step_norm = 0, x_norm = 0;
+        for (int i = 0; i < dim; ++i) {
+            new_x[i] += step(i);
+            step_norm += step(i) * step(i);
+            x_norm += new_x[i] * new_x[i];
+        }
+        // The damping has grown so large that the step no longer changes the point.
+        if (std::sqrt(step_norm) <= DBL_EPSILON * (std::sqrt(x_norm) + DBL_EPSILON))
+            break;
+
+        double rho = -1;
+        double new_f = seq_f_i.back();
+        if (area.is_inside(new_x)) {
+            new_f = residual_function->evaluate_residuals(new_x, new_r);
+            // Decrease predicted by the linear model: |r|^2 - |r + J d|^2 = lambda * d^T D d - d^T J^T r.
+            double predicted = lambda * step.dot(scale.cwiseProduct(step)) - step.dot(jtr);
+            if (predicted > 0)
+                rho = (seq_f_i.back() - new_f) / predicted;
+        }
+
+        if (rho > 0 && new_f < seq_f_i.back()) {
+            seq_x_i.push_back(new_x);
+            seq_f_i.push_back(new_f);
+            ++num_of_iter;
+            ++num_of_iter_since_last_approx;
+            record_point(new_x, new_f, num_of_iter, true);
+
+            lambda *= std::max(1.0 / 3, 1 - std::pow(2 * rho - 1, 3));
+            nu = 2;
+            linearize();
+            checkpoint_if_due();
+        }
+        else {
+            if (area.is_inside(new_x))
+                record_point(new_x, new_f, num_of_iter + 1, false);
+            lambda *= nu;
+            nu *= 2;
+            ++num_of_rejections;
+        }
+    }
+
+    checkpoint_on_finish();
+}
+
+void Levenberg_marquardt::save_state(std::ostream& out) {
+    Optimization_method::save_state(out);
+    Checkpoint::write_value<double>(out, lambda);
+    Checkpoint::write_value<double>(out, nu);
+    Checkpoint::write_value<int32_t>(out, num_of_rejections);
+}
+
+void Levenberg_marquardt::load_state(std::istream& in) {
+    Optimization_method::load_state(in);
+    lambda = Checkpoint::read_value<double>(in);
+    nu = Checkpoint::read_value<double>(in);
+    num_of_rejections = Checkpoint::read_value<int32_t>(in);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Stop_criterion.h"
+#include "Optimization_method.h"
+#include <vector>
+#include <Eigen/Dense>
+
+/**
+ * @brief Levenberg-Marquardt method for sums of squared residuals.
+ *
+ * Every iteration solves (J^T J + lambda * D) d = -J^T r, where D is the diagonal of J^T J, and accepts
+ * the step if it decreases the function. The damping lambda follows Nielsen's rule: it shrinks after
+ * steps that agree with the linear model of the residuals and doubles at an increasing rate after
+ * rejected steps, so the method moves between Gauss-Newton and scaled gradient descent. An iteration
+ * costs one evaluation of r and, for a finite-difference Jacobian, dim more. The gradient 2 J^T r is
+ * passed to the stopping criterion, so Criterion_grad_f needs no extra evaluations.
+ */
+class Levenberg_marquardt : public Optimization_method {
+private:
+    Residual_function* residual_function; /**< Objective function as a residual vector, the same object as function. */
+    double damping_factor; /**< Initial damping relative to the largest diagonal element of J^T J. */
+    double lambda; /**< Current damping. */
+    double nu; /**< Factor increasing the damping after the next rejected step. */
+    int num_of_rejections; /**< Number of rejected steps. */
+
+protected:
+    /**
+     * @brief Serializes the state together with the damping.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
+
+public:
+    /**
+     * @brief Constructor for the Levenberg-Marquardt method.
+     * @param function Pointer to the objective function.
+     * @param x_0 Initial point for optimization.
+     * @param area Area constraint for optimization.
+     * @param stop_criterion Pointer to the stopping criterion.
+     * @param damping_factor_ Initial damping relative to the largest diagonal element of J^T J.
+     */
+    Levenberg_marquardt(Residual_function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+        double damping_factor_ = 1e-3);
+
+    /**
+     * @brief Getter for the current damping.
+     * @return Damping lambda.
+     */
+    double get_lambda();
+
+    /**
+     * @brief Getter for the number of rejected steps.
+     * @return Number of steps that did not decrease the function.
+     */
+    int get_num_of_rejections();
+
+    /**
+     * @brief Perform the Levenberg-Marquardt optimization.
+     */
+    void optimization() override;
+};
@@ -0,0 +1,273 @@
+#include "Multilevel_search.h"
+#include "Newton_opt.h"
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <cfloat>
+#include <Eigen/Dense>
+
+Multilevel_search::Multilevel_search(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+    double local_eps_, int local_max_iter_, int batch_size_, double reduced_fraction_, double sigma_)
+    : Optimization_method(function, x_0, area, stop_criterion),
+    seed(static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count())), box(area.get_box()),
+    batch_size(batch_size_), reduced_fraction(reduced_fraction_), sigma(sigma_), local_eps(local_eps_),
+    local_max_iter(local_max_iter_), num_of_local_searches(0) {
+    int dim = function->get_dim();
+
+    if (box.size() != static_cast<size_t>(dim))
+        throw std::invalid_argument("Multi-level search requires a bounded non-empty area of the function dimension.");
+    for (int i = 0; i < dim; ++i) {
+        if (!std::isfinite(box[i].first) || !std::isfinite(box[i].second) || box[i].first > box[i].second)
+            throw std::invalid_argument("Multi-level search requires a bounded non-empty area of the function dimension.");
+    }
+    if (batch_size <= 0 || reduced_fraction <= 0 || reduced_fraction > 1)
+        throw std::invalid_argument("Invalid batch size or reduced fraction of the multi-level search.");
+    std::unique_ptr<Function> probe(function->clone());
+    if (!probe)
+        throw std::invalid_argument("Multi-level search requires a function supporting clone().");
+
+    if (dim <= Sampler_sobol::max_dim)
+        sampler.reset(new Sampler_sobol(dim, seed));
+    else
+        sampler.reset(new Sampler_halton(dim, seed));
+
+    double diameter = 0;
+    for (int i = 0; i < dim; ++i) {
+        diameter += (box[i].second - box[i].first) * (box[i].second - box[i].first);
+    }
+    merge_distance = 1e-4 * std::sqrt(diameter);
+}
+
+const std::vector<Basin>& Multilevel_search::get_basins() {
+    return basins;
+}
+
+int Multilevel_search::get_num_of_local_searches() {
+    return num_of_local_searches;
+}
+
+int Multilevel_search::get_num_of_samples() {
+    return static_cast<int>(sample_f.size());
+}
+
+double Multilevel_search::critical_distance() {
+    int dim = function->get_dim();
+    double n = dim, kn = static_cast<double>(sample_f.size());
+    double volume = 1;
+    for (int i = 0; i < dim; ++i) {
+        volume *= box[i].second - box[i].first;
+    }
+
+    // r_k = pi^(-1/2) * (Gamma(1 + n / 2) * m(S) * sigma * ln(kN) / kN)^(1 / n), Rinnooy Kan and Timmer.
+    const double pi = 3.14159265358979323846;
+    return std::pow(std::tgamma(1 + n / 2) * volume * sigma * std::log(kn) / kn, 1 / n) / std::sqrt(pi);
+}
+
+void Multilevel_search::sample_batch() {
+    int dim = function->get_dim();
+    size_t first = sample_f.size();
+    sample_x.resize((first + batch_size) * dim);
+    sample_f.resize(first + batch_size);
+    is_started.resize(first + batch_size, 0);
+
+    std::vector<double> x(dim);
+    for (size_t k = first; k < sample_f.size(); ++k) {
+        sampler->next(x.data());
+        for (int i = 0; i < dim; ++i) {
+            x[i] = box[i].first + x[i] * (box[i].second - box[i].first);
+        }
+        std::copy(x.begin(), x.end(), sample_x.begin() + k * dim);
+        sample_f[k] = function->evaluate(x);
+        record_point(x, sample_f[k], num_of_iter, false);
+    }
+}
+
+bool Multilevel_search::is_local_minimum(Optimization_method& local) {
+    int dim = function->get_dim();
+    const std::vector<double>& x = local.get_x();
+    double f = local.get_f();
+
+    std::vector<std::vector<double>> hess = local.hessian(x);
+    Eigen::MatrixXd hessian_matrix(dim, dim);
+    for (int i = 0; i < dim; ++i) {
+        for (int j = 0; j < dim; ++j) {
+            hessian_matrix(i, j) = (hess[i][j] + hess[j][i]) / 2;
+        }
+    }
+    bool is_finite = hessian_matrix.allFinite();
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen;
+    if (is_finite) {
+        eigen.compute(hessian_matrix);
+        if (eigen.eigenvalues().minCoeff() > 0)
+            return true;
+    }
+
+    // A singular or indefinite estimate is settled by the function: no nearby point of a minimum is lower.
+    // Without a usable Hessian the coordinate directions are probed instead.
+    Eigen::MatrixXd directions = is_finite ? eigen.eigenvectors() : Eigen::MatrixXd::Identity(dim, dim);
+    double tolerance = 16 * DBL_EPSILON * std::max(std::fabs(f), 1.0);
+    std::vector<double> y(dim);
+    for (int k = 0; k < dim; ++k) {
+        if (is_finite && eigen.eigenvalues()(k) > 0)
+            continue;
+        for (double sign : { -1.0, 1.0 }) {
+            for (int i = 0; i < dim; ++i) {
+                y[i] = x[i] + sign * merge_distance * directions(i, k);
+            }
+            if (area.is_inside(y) && local.get_function()->evaluate(y) < f - tolerance)
+                return false;
+        }
+    }
+    return true;
+}
+
+void Multilevel_search::local_search(int k) {
+    int dim = function->get_dim();
+    std::vector<double> x_0(sample_x.begin() + static_cast<size_t>(k) * dim, sample_x.begin() + static_cast<size_t>(k + 1) * dim);
+    is_started[k] = 1;
+    ++num_of_local_searches;
+
+    Function* copy = function->clone();
+    long long start_num_of_evaluations = copy->get_num_of_evaluations();
+    Newton_opt newton(copy, x_0, area, new Criterion_grad_f(local_eps, local_max_iter));
+    newton.optimization();
+    bool is_minimum = is_local_minimum(newton);
+    function->add_num_of_evaluations(copy->get_num_of_evaluations() - start_num_of_evaluations);
+
+    const std::vector<double>& x = newton.get_x();
+    double f = newton.get_f();
+
+    if (f < seq_f_i.back()) {
+        seq_x_i.push_back(x);
+        seq_f_i.push_back(f);
+        num_of_iter_since_last_approx = 0;
+        record_point(x, f, num_of_iter, true);
+    }
+    if (!is_minimum)
+        return;
+
+    auto basin = std::find_if(basins.begin(), basins.end(), [&](const Basin& b) {
+        double dist = 0;
+        for (int i = 0; i < dim; ++i) {
+            dist += (b.x[i] - x[i]) * (b.x[i] - x[i]);
+        }
+        return std::sqrt(dist) < merge_distance;
+    });
+    if (basin == basins.end()) {
+        basins.push_back(Basin{ x, f, 1 });
+    }
+    else {
+        ++basin->num_of_hits;
+        if (f < basin->f) {
+            basin->x = x;
+            basin->f = f;
+        }
+    }
+}
+
+void Multilevel_search::optimization() {
+    if (!is_resumed) {
+        num_of_iter = 0;
+        num_of_iter_since_last_approx = 0;
+    }
+    is_resumed = false;
+
+    int dim = function->get_dim();
+
+    while (!is_finished()) {
+        ++num_of_iter;
+        ++num_of_iter_since_last_approx;
+
+        sample_batch();
+
+        // Reduced sample: the best fraction of all points drawn so far, in ascending order of f.
+        size_t size = sample_f.size();
+        size_t reduced_size = std::max<size_t>(1, static_cast<size_t>(std::ceil(reduced_fraction * size)));
+        std::vector<int> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        auto by_f = [this](int a, int b) { return sample_f[a] < sample_f[b]; };
+        std::partial_sort(order.begin(), order.begin() + reduced_size, order.end(), by_f);
+        order.resize(reduced_size);
+
+        double r = critical_distance();
+        double r2 = r * r;
+        auto is_near = [&](const double* a, const double* b) {
+            double dist = 0;
+            for (int i = 0; i < dim && dist < r2; ++i) {
+                dist += (a[i] - b[i]) * (a[i] - b[i]);
+            }
+            return dist < r2;
+        };
+
+        for (size_t j = 0; j < reduced_size; ++j) {
+            int k = order[j];
+            if (is_started[k])
+                continue;
+
+            const double* x = sample_x.data() + static_cast<size_t>(k) * dim;
+            bool is_linked = false;
+            for (size_t l = 0; l < j && !is_linked; ++l) {
+                is_linked = is_near(x, sample_x.data() + static_cast<size_t>(order[l]) * dim);
+            }
+            for (size_t b = 0; b < basins.size() && !is_linked; ++b) {
+                is_linked = is_near(x, basins[b].x.data());
+            }
+            if (is_linked)
+                continue;
+
+            local_search(k);
+            if (control && control->get_is_cancelled())
+                break;
+        }
+
+        checkpoint_if_due();
+    }
+
+    checkpoint_on_finish();
+}
+
+void Multilevel_search::save_state(std::ostream& out) {
+    Optimization_method::save_state(out);
+
+    int dim = function->get_dim();
+    Checkpoint::write_value<uint32_t>(out, seed);
+    sampler->save_state(out);
+    Checkpoint::write_value<int32_t>(out, num_of_local_searches);
+    Checkpoint::write_value<uint64_t>(out, sample_f.size());
+    out.write(reinterpret_cast<const char*>(sample_x.data()), sample_x.size() * sizeof(double));
+    out.write(reinterpret_cast<const char*>(sample_f.data()), sample_f.size() * sizeof(double));
+    out.write(is_started.data(), is_started.size());
+    Checkpoint::write_value<uint64_t>(out, basins.size());
+    for (const Basin& basin : basins) {
+        out.write(reinterpret_cast<const char*>(basin.x.data()), dim * sizeof(double));
+        Checkpoint::write_value<double>(out, basin.f);
+        Checkpoint::write_value<int32_t>(out, basin.num_of_hits);
+    }
+}
+
+void Multilevel_search::load_state(std::istream& in) {
+    Optimization_method::load_state(in);
+
+    int dim = function->get_dim();
+    seed = Checkpoint::read_value<uint32_t>(in);
+    sampler->load_state(in);
+    num_of_local_searches = Checkpoint::read_value<int32_t>(in);
+
+    uint64_t size = Checkpoint::read_value<uint64_t>(in);
+    sample_x.resize(size * dim);
+    sample_f.resize(size);
+    is_started.resize(size);
+    if (!in.read(reinterpret_cast<char*>(sample_x.data()), sample_x.size() * sizeof(double))
+        || !in.read(reinterpret_cast<char*>(sample_f.data()), sample_f.size() * sizeof(double))
+        || !in.read(is_started.data(), is_started.size()))
+        throw std::runtime_error("Checkpoint file is truncated.");
+
+    basins.resize(Checkpoint::read_value<uint64_t>(in));
+    for (Basin& basin : basins) {
+        basin.x.resize(dim);
+        if (!in.read(reinterpret_cast<char*>(basin.x.data()), dim * sizeof(double)))
+            throw std::runtime_error("Checkpoint file is truncated.");
+        basin.f = Checkpoint::read_value<double>(in);
+        basin.num_of_hits = Checkpoint::read_value<int32_t>(in);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Stop_criterion.h"
+#include "Optimization_method.h"
+#include "Sampler.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+
+/**
+ * @brief Local minimum found by the multi-level single linkage search.
+ */
+struct Basin {
+    std::vector<double> x; /**< Local minimum. */
+    double f; /**< Function value at the local minimum. */
+    int num_of_hits; /**< Number of local searches that converged to the minimum. */
+};
+
+/**
+ * @brief Global optimization method combining sampling, clustering and Newton's method (multi-level single linkage).
+ *
+ * One iteration draws a batch of points in the area and keeps the best fraction of all points drawn so far.
+ * A local search with Newton's method starts only from a kept point that has no better kept point within
+ * the critical distance r_k and no known local minimum within r_k, i.e. from the best point of a basin
+ * that has not been explored yet. r_k shrinks as the number of samples grows, so the number of local
+ * searches grows with the number of minima rather than with the number of samples.
+ * Newton's method also converges to saddle points and maxima; such a result does not become a basin.
+ * Every local search works on a copy of the function (see Function::clone).
+ */
+class Multilevel_search : public Optimization_method {
+private:
+    unsigned seed; /**< Seed for the sampler. */
+    std::unique_ptr<Sampler> sampler; /**< Generator of the sample points in the unit cube. */
+    std::vector<std::pair<double, double>> box; /**< Bounding box of the area. */
+    int batch_size; /**< Number of points drawn per iteration. */
+    double reduced_fraction; /**< Fraction of the best samples kept as possible starting points. */
+    double sigma; /**< Scale of the critical distance, sigma > 2 guarantees finitely many local searches. */
+    double local_eps; /**< Tolerance of the gradient norm in the local searches. */
+    int local_max_iter; /**< Maximum number of iterations of a local search. */
+    double merge_distance; /**< Distance below which two local minima are considered equal. */
+    std::vector<double> sample_x; /**< Sample points one after another, dim values each. */
+    std::vector<double> sample_f; /**< Function values of the sample points. */
+    std::vector<char> is_started; /**< True for the sample points a local search has started from. */
+    std::vector<Basin> basins; /**< Local minima found so far. */
+    int num_of_local_searches; /**< Number of local searches performed. */
+
+    /**
+     * @brief Calculates the critical distance for the current number of samples.
+     * @return Critical distance r_k.
+     */
+    double critical_distance();
+
+    /**
+     * @brief Draws a batch of sample points and evaluates them.
+     */
+    void sample_batch();
+
+    /**
+     * @brief Checks whether the point a local search has converged to is a local minimum.
+     * The point is accepted if the Hessian matrix there is positive definite. Otherwise it is accepted only if
+     * no point of the area at merge_distance along an eigenvector of non-positive curvature has a lower value.
+     * @param local Local search that has converged to the point.
+     * @return True if the point is a local minimum, false for a saddle point or a maximum.
+     */
+    bool is_local_minimum(Optimization_method& local);
+
+    /**
+     * @brief Runs Newton's method from a sample point and merges the result into the basins if it is a local minimum.
+     * @param k Index of the sample point.
+     */
+    void local_search(int k);
+
+protected:
+    /**
+     * @brief Serializes the state of the search, including the samples and the basins.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
+
+public:
+    /**
+     * @brief Constructor for the multi-level single linkage search.
+     * @param function Pointer to the objective function, must support Function::clone.
+     * @param x_0 Initial point for optimization.
+     * @param area Bounded non-empty area of the search.
+     * @param stop_criterion Pointer to the stopping criterion of the global search; one iteration is one batch.
+     * @param local_eps_ Tolerance of the gradient norm in the local searches.
+     * @param local_max_iter_ Maximum number of iterations of a local search.
+     * @param batch_size_ Number of points drawn per iteration.
+     * @param reduced_fraction_ Fraction of the best samples kept as possible starting points.
+     * @param sigma_ Scale of the critical distance.
+     */
+    Multilevel_search(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+        double local_eps_ = 1e-6, int local_max_iter_ = 100, int batch_size_ = 100, double reduced_fraction_ = 0.1,
+        double sigma_ = 4);
+
+    /**
+     * @brief Getter for the local minima found so far.
+     * @return Local minima in the order they were found.
+     */
+    const std::vector<Basin>& get_basins();
+
+    /**
+     * @brief Getter for the number of local searches performed.
+     * @return Number of local searches.
+     */
+    int get_num_of_local_searches();
+
+    /**
+     * @brief Getter for the number of sample points drawn.
+     * @return Number of sample points.
+     */
+    int get_num_of_samples();
+
+    /**
+     * @brief Perform the multi-level single linkage optimization.
+     */
+    void optimization() override;
+};
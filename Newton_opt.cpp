@@ -1,35 +1,150 @@
 #include "Newton_opt.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+Newton_opt::Newton_opt() : max_hessian_reuse(1), rate_threshold(0.5), is_low_rank_update(false), hessian_age(0), last_grad_norm(0),
+    is_hessian_stale(true), num_of_hessians(0), is_warm_started(false), beta(0.5), num_of_speculative_trials(1) {}
+
+Newton_opt::~Newton_opt() {
+    for (Function* clone : clones) {
+        delete clone;
+    }
+}
 
-Newton_opt::Newton_opt(){}
+Newton_opt::Newton_opt(Function* function, std::vector<double> x_0, Area area,
+    Stop_criterion* stop_criterion) : Optimization_method(function, x_0, area, stop_criterion), max_hessian_reuse(1),
+    rate_threshold(0.5), is_low_rank_update(false), hessian_age(0), last_grad_norm(0), is_hessian_stale(true), num_of_hessians(0),
+    is_warm_started(false), beta(0.5), num_of_speculative_trials(1) {
+}
 
-Newton_opt::~Newton_opt() {}
+void Newton_opt::set_hessian_reuse(int max_hessian_reuse_, double rate_threshold_, bool is_low_rank_update_) {
+    max_hessian_reuse = std::max(max_hessian_reuse_, 1);
+    rate_threshold = rate_threshold_;
+    is_low_rank_update = is_low_rank_update_;
+    is_hessian_stale = true;
+}
 
-Newton_opt::Newton_opt(Function* function, std::vector<double> x_0, Area area,
-    Stop_criterion* stop_criterion) : Optimization_method(function, x_0, area, stop_criterion) {
+void Newton_opt::set_backtracking(double beta_) {
+    if (!(beta_ > 0 && beta_ < 1))
+        throw std::invalid_argument("Backtracking factor must be in (0; 1).");
+    beta = beta_;
 }
 
-void Newton_opt::optimization() {
-    int dim = function->get_dim();
-    double eps = stop_criterion->get_eps();
+void Newton_opt::set_speculative_line_search(int num_of_threads, int num_of_trials) {
+    if (num_of_trials < 0)
+        throw std::invalid_argument("Number of speculative trials must be non-negative.");
 
-    while (!stop_criterion->termination(this)) {
-        std::vector<std::vector<double>> hess = function->hessian(seq_x_i.back(), eps / 10, area);
-        
-        Eigen::MatrixXd hessian_matrix(dim, dim);
-        for (int i = 0; i < dim; i++) {
-            for (int j = 0; j < dim; j++) {
-                hessian_matrix(i, j) = hess[i][j];
+    for (Function* clone : clones) {
+        delete clone;
+    }
+    clones.clear();
+    pool.reset(new Thread_pool(num_of_threads));
+    num_of_speculative_trials = num_of_trials > 0 ? num_of_trials : pool->get_num_of_threads();
+    // A single thread would only evaluate the ladder serially, overshooting the step the serial search stops at.
+    if (num_of_speculative_trials > 1 && pool->get_num_of_threads() > 1) {
+        for (int t = 0; t < pool->get_num_of_threads(); ++t) {
+            Function* clone = function->clone();
+            if (clone == nullptr) {
+                for (Function* c : clones) {
+                    delete c;
+                }
+                clones.clear();
+                break;
             }
+            clones.push_back(clone);
         }
+    }
+    if (clones.empty()) {
+        pool.reset();
+        num_of_speculative_trials = 1;
+    }
+}
+
+void Newton_opt::warm_start(const Eigen::MatrixXd& inverse_hessian_matrix_) {
+    int dim = function->get_dim();
+    if (inverse_hessian_matrix_.rows() != dim || inverse_hessian_matrix_.cols() != dim)
+        throw std::invalid_argument("Inverse Hessian matrix dimension does not match the function.");
+
+    inverse_hessian_matrix = inverse_hessian_matrix_;
+    hessian_age = 0;
+    last_grad_norm = std::numeric_limits<double>::infinity();
+    is_warm_started = true;
+}
+
+const Eigen::MatrixXd& Newton_opt::get_inverse_hessian() {
+    return inverse_hessian_matrix;
+}
 
-        Eigen::MatrixXd inverse_hessian_matrix = hessian_matrix.inverse();
+int Newton_opt::get_num_of_hessians() {
+    return num_of_hessians;
+}
 
-        std::vector<double> grad = function->gradient(seq_x_i.back(), eps / 10, area);
+void Newton_opt::optimization() {
+    int dim = function->get_dim();
+    is_resumed = false;
+    is_hessian_stale = !is_warm_started;
+    is_warm_started = false;
+    is_single_phase = is_mixed_precision;
+    is_single_exhausted = false;
+
+    while (!is_finished()) {
+        TRACE_SCOPE("iteration");
+        std::vector<double> grad = gradient(seq_x_i.back());
+        if (is_single_exhausted) {
+            leave_single_precision();
+            is_hessian_stale = true;
+        }
 
         Eigen::VectorXd grad_vector(dim);
+        double grad_norm = 0;
         for (int i = 0; i < dim; i++) {
             grad_vector(i) = grad[i];
+            grad_norm += grad[i] * grad[i];
+        }
+        grad_norm = std::sqrt(grad_norm);
+
+        // A reused inverse is refreshed when it is too old or the gradient no longer shrinks fast enough.
+        bool is_fresh = false;
+        if (is_hessian_stale || hessian_age >= max_hessian_reuse || grad_norm > rate_threshold * last_grad_norm) {
+            std::vector<std::vector<double>> hess = hessian(seq_x_i.back());
+            // A Hessian cut short by the run control is incomplete.
+            if (is_interrupted())
+                break;
+
+            Eigen::MatrixXd hessian_matrix(dim, dim);
+            for (int i = 0; i < dim; i++) {
+                for (int j = 0; j < dim; j++) {
+                    hessian_matrix(i, j) = hess[i][j];
+                }
+            }
+
+            TRACE_SCOPE("inverse");
+            inverse_hessian_matrix = hessian_matrix.inverse();
+            hessian_age = 0;
+            is_hessian_stale = false;
+            is_fresh = true;
+            ++num_of_hessians;
+        }
+        else if (is_low_rank_update && hessian_age > 0) {
+            // BFGS update of the reused inverse with the last step s and the change of the gradient y.
+            // A warm-started inverse has no step of this run yet.
+            Eigen::VectorXd s = Eigen::Map<const Eigen::VectorXd>(seq_x_i.back().data(), dim)
+                - Eigen::Map<const Eigen::VectorXd>(seq_x_i[seq_x_i.size() - 2].data(), dim);
+            Eigen::VectorXd y = grad_vector - last_grad;
+            double s_y = s.dot(y);
+            if (s_y > 0) {
+                Eigen::VectorXd h_y = inverse_hessian_matrix * y;
+                double y_h_y = y.dot(h_y);
+                inverse_hessian_matrix += ((s_y + y_h_y) / (s_y * s_y)) * (s * s.transpose())
+                    - (h_y * s.transpose() + s * h_y.transpose()) / s_y;
+            }
         }
+        ++hessian_age;
+        last_grad_norm = grad_norm;
+        last_grad = grad_vector;
 
         Eigen::VectorXd hess_times_grad = inverse_hessian_matrix * grad_vector;
 
@@ -40,28 +155,85 @@ void Newton_opt::optimization() {
         }
 
         double alpha = 1.0;
-        double beta = 0.5;
+        std::vector<std::vector<double>> trial_x(num_of_speculative_trials);
+        std::vector<double> trial_alpha(num_of_speculative_trials), trial_f(num_of_speculative_trials);
+        std::vector<char> is_trial_inside(num_of_speculative_trials);
+        bool is_stopped = false;
 
         while (true) {
-            std::vector<double> new_x = seq_x_i.back();
-            for (int i = 0; i < dim; ++i) {
-                new_x[i] += alpha * p[i];
+            TRACE_SCOPE("backtrack");
+            if (is_interrupted()) {
+                is_stopped = true;
+                break;
+            }
+            for (int k = 0; k < num_of_speculative_trials; ++k) {
+                trial_alpha[k] = k == 0 ? alpha : trial_alpha[k - 1] * beta;
+                trial_x[k] = seq_x_i.back();
+                // Once alpha underflows the step is empty; this also ends the search for a non-finite direction.
+                if (trial_alpha[k] > DBL_MIN) {
+                    for (int i = 0; i < dim; ++i) {
+                        trial_x[k][i] += trial_alpha[k] * p[i];
+                    }
+                }
             }
 
-            double new_f_x = function->calculate(new_x);
-
-            if (new_f_x <= seq_f_i.back()) {
+            if (clones.empty()) {
+                trial_f[0] = function->evaluate(trial_x[0]);
+                is_trial_inside[0] = area.is_inside(trial_x[0]);
+            }
+            else {
+                pool->parallel_for(num_of_speculative_trials, [&](int begin, int end, int thread) {
+                    TRACE_SCOPE("speculative trials");
+                    for (int k = begin; k < end; ++k) {
+                        trial_f[k] = clones[thread]->calculate(trial_x[k]);
+                        is_trial_inside[k] = area.is_inside(trial_x[k]);
+                    }
+                });
+                function->add_num_of_evaluations(num_of_speculative_trials);
+            }
 
-                if (area.is_inside(new_x)) {
-                    seq_x_i.push_back(new_x);
-                    seq_f_i.push_back(new_f_x);
-                    ++num_of_iter;
-                    ++num_of_iter_since_last_approx;
-                    break;
-                }
+            // The largest acceptable step is the one the serial search would stop at.
+            // An empty step would only repeat the current iterate, so it ends the run instead of being accepted.
+            // A non-finite value fails the comparison and is backtracked like any other unacceptable step.
+            int accepted = -1;
+            for (int k = 0; k < num_of_speculative_trials && accepted < 0 && !is_stopped; ++k) {
+                if (!(trial_alpha[k] > DBL_MIN))
+                    is_stopped = true;
+                else if (trial_f[k] <= seq_f_i.back() && is_trial_inside[k])
+                    accepted = k;
+            }
+            for (int k = 0; k < num_of_speculative_trials; ++k) {
+                if (k != accepted)
+                    record_point(trial_x[k], trial_f[k], num_of_iter + 1, false);
             }
 
-            alpha *= beta;
+            if (accepted >= 0) {
+                alpha = trial_alpha[accepted];
+                seq_x_i.push_back(trial_x[accepted]);
+                seq_f_i.push_back(trial_f[accepted]);
+                ++num_of_iter;
+                ++num_of_iter_since_last_approx;
+                record_point(trial_x[accepted], trial_f[accepted], num_of_iter, true);
+                checkpoint_if_due();
+                break;
+            }
+            if (is_stopped)
+                break;
+            alpha = trial_alpha.back() * beta;
+        }
+        if (is_stopped)
+            break;
+
+        // A reused inverse that needed backtracking no longer describes the function well.
+        if (alpha < 1 && !is_fresh)
+            is_hessian_stale = true;
+        // A direction from single precision derivatives this poor is not worth another float iteration.
+        if (is_single_phase && alpha < 1.0 / 1024) {
+            leave_single_precision();
+            is_hessian_stale = true;
         }
     }
+
+    leave_single_precision();
+    checkpoint_on_finish();
 }
\ No newline at end of file
@@ -9,12 +9,40 @@
 #include <cfloat>
 #include "Stop_criterion.h"
 #include "Optimization_method.h"
+#include "Thread_pool.h"
+#include <memory>
 #include <Eigen/Dense>
 
 /**
  * @brief Newton's optimization method class.
+ *
+ * By default the Hessian matrix is calculated and inverted at every iteration. With set_hessian_reuse
+ * the inverse is kept for several iterations (Shamanskii's method), which saves the 4 * dim^2
+ * evaluations of a finite-difference Hessian near the minimum, where the matrix changes little.
+ *
+ * The backtracking line search tries the steps alpha = 1, beta, beta^2, ... one after another. With
+ * set_speculative_line_search a ladder of these steps is evaluated at once on copies of the function
+ * (see Function::clone), and the largest acceptable one is taken, so a line search usually costs the
+ * time of one evaluation. The iterates are the same as with the serial search. A step that has shrunk
+ * to zero without an acceptable value ends the optimization.
  */
 class Newton_opt : public Optimization_method {
+private:
+    int max_hessian_reuse; /**< Maximum number of iterations using the same inverse Hessian matrix. */
+    double rate_threshold; /**< The inverse is refreshed if the gradient norm shrinks by less than this factor. */
+    bool is_low_rank_update; /**< True if the reused inverse is corrected by BFGS updates between refreshes. */
+    int hessian_age; /**< Number of iterations that have used the current inverse. */
+    double last_grad_norm; /**< Gradient norm at the previous iteration. */
+    bool is_hessian_stale; /**< True if the inverse must be refreshed at the next iteration. */
+    int num_of_hessians; /**< Number of calculated Hessian matrices. */
+    bool is_warm_started; /**< True if the next optimization starts with an inverse given by warm_start. */
+    double beta; /**< Factor by which the line search shrinks the step. */
+    Eigen::MatrixXd inverse_hessian_matrix; /**< Current inverse Hessian matrix. */
+    Eigen::VectorXd last_grad; /**< Gradient at the previous iteration. */
+    int num_of_speculative_trials; /**< Number of steps the line search evaluates at once, 1 for the serial search. */
+    std::unique_ptr<Thread_pool> pool; /**< Threads evaluating the speculative steps, null for the serial search. */
+    std::vector<Function*> clones; /**< Copy of the function for every thread, empty for the serial search. */
+
 public:
     /**
      * @brief Default constructor.
@@ -31,10 +59,54 @@ public:
     Newton_opt(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion);
 
     /**
-     * @brief Destructor for Newton's optimization method.
+     * @brief Destructor for Newton's optimization method. Deletes the copies of the function.
      */
     ~Newton_opt();
 
+    /**
+     * @brief Enables reuse of the inverse Hessian matrix.
+     * The inverse is refreshed after max_hessian_reuse_ iterations, when the gradient norm shrinks by less than
+     * rate_threshold_ per iteration, or when a step with the reused inverse needed backtracking.
+     * @param max_hessian_reuse_ Maximum number of iterations using the same inverse, 1 refreshes it every iteration.
+     * @param rate_threshold_ Required ratio of consecutive gradient norms, in (0; 1].
+     * @param is_low_rank_update_ If true, the reused inverse is corrected by a rank-two BFGS update after every step.
+     */
+    void set_hessian_reuse(int max_hessian_reuse_, double rate_threshold_ = 0.5, bool is_low_rank_update_ = false);
+
+    /**
+     * @brief Sets the factor by which the backtracking line search shrinks the step after a rejected trial.
+     * @param beta_ Shrinking factor in (0; 1), 0.5 by default.
+     */
+    void set_backtracking(double beta_);
+
+    /**
+     * @brief Makes the line search evaluate a ladder of steps alpha, alpha * beta, alpha * beta^2, ... concurrently,
+     * checking them against the area in parallel as well, and take the largest acceptable one. If none is
+     * acceptable, the next ladder continues below the last step. A function without clone() keeps the serial search.
+     * @param num_of_threads Number of threads, 0 for the number of hardware threads; 1 restores the serial search.
+     * @param num_of_trials Number of steps in a ladder, 0 for one per thread.
+     */
+    void set_speculative_line_search(int num_of_threads = 0, int num_of_trials = 0);
+
+    /**
+     * @brief Makes the next optimization start with a given inverse Hessian matrix instead of calculating one,
+     * e.g. the matrix of a closely related problem. The matrix is refreshed under the rules of set_hessian_reuse.
+     * @param inverse_hessian_matrix_ Inverse Hessian matrix of the function dimension.
+     */
+    void warm_start(const Eigen::MatrixXd& inverse_hessian_matrix_);
+
+    /**
+     * @brief Getter for the current inverse Hessian matrix.
+     * @return Inverse Hessian matrix used by the last iteration, empty before the first one.
+     */
+    const Eigen::MatrixXd& get_inverse_hessian();
+
+    /**
+     * @brief Getter for the number of calculated Hessian matrices.
+     * @return Number of Hessian matrices.
+     */
+    int get_num_of_hessians();
+
     /**
      * @brief Perform the Newton optimization.
      */
@@ -0,0 +1,179 @@
+#include "Newton_opt_api.h"
+#include "Newton_opt.h"
+#include "Random_search.h"
+#include "Population_search.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    thread_local std::string last_error;
+
+    /**
+     * @brief Function calling the objectives of a C problem on the coordinates of the points in place.
+     */
+    class Callback_function : public Function {
+    private:
+        newton_opt_objective objective; /**< Objective of one point. */
+        newton_opt_batch_objective batch_objective; /**< Objective of many points, null if there is none. */
+        void* user_data; /**< Pointer passed to the objectives. */
+
+    public:
+        explicit Callback_function(const newton_opt_problem& problem)
+            : Function(problem.dim), objective(problem.objective), batch_objective(problem.batch_objective),
+            user_data(problem.user_data) {}
+
+        Function* clone() const override {
+            return new Callback_function(*this);
+        }
+
+        double calculate(const std::vector<double>& x_) override {
+            f = objective(x_.data(), dim, user_data);
+            return f;
+        }
+
+        void calculate_batch(const double* points, int n, double* values) override {
+            if (batch_objective == nullptr) {
+                for (int k = 0; k < n; ++k) {
+                    values[k] = objective(points + k * dim, dim, user_data);
+                }
+                return;
+            }
+            batch_objective(points, n, dim, values, user_data);
+        }
+    };
+
+    // Sizes of the structures of version 2, the first with struct_size; no caller has smaller ones.
+    const size_t min_problem_size = offsetof(newton_opt_problem, upper) + sizeof(const double*);
+    const size_t min_options_size = offsetof(newton_opt_options, num_of_threads) + sizeof(int);
+    const size_t min_result_size = offsetof(newton_opt_result, num_of_evaluations) + sizeof(long long);
+
+    int fail(int status, const std::string& message) {
+        last_error = message;
+        return status;
+    }
+
+    /**
+     * @brief Copies the fields after struct_size that lie inside the first size bytes of a structure.
+     * @param from Source structure.
+     * @param to Destination structure; its struct_size and the fields past size are left unchanged.
+     * @param size Size of the smaller of the two structures.
+     */
+    template <typename T>
+    void copy_fields(const T& from, T& to, size_t size) {
+        size = std::min(size, sizeof(T));
+        std::memcpy(reinterpret_cast<char*>(&to) + sizeof(size_t), reinterpret_cast<const char*>(&from) + sizeof(size_t),
+            size - sizeof(size_t));
+    }
+
+    void fill_defaults(newton_opt_options& options) {
+        options.struct_size = sizeof(newton_opt_options);
+        options.method = NEWTON_OPT_NEWTON;
+        options.eps = 1e-6;
+        options.max_iter = 100;
+        options.p = 0.5;
+        options.delta = 1;
+        options.alpha = 1;
+        options.population_size = 0;
+        options.sigma = 0;
+        options.num_of_threads = 1;
+    }
+}
+
+int newton_opt_default_options(newton_opt_options* options) {
+    last_error.clear();
+    if (options == nullptr || options->struct_size < min_options_size)
+        return fail(NEWTON_OPT_INVALID_ARGUMENT, "Options must not be null and struct_size must be set to sizeof(newton_opt_options).");
+
+    newton_opt_options defaults;
+    fill_defaults(defaults);
+    copy_fields(defaults, *options, options->struct_size);
+    return NEWTON_OPT_OK;
+}
+
+int newton_opt_minimize(const newton_opt_problem* problem, const double* x_0,
+    const newton_opt_options* options, double* x, newton_opt_result* result) {
+    last_error.clear();
+    if (problem == nullptr || x_0 == nullptr || x == nullptr)
+        return fail(NEWTON_OPT_INVALID_ARGUMENT, "Problem, start point and result point must not be null.");
+    if (problem->struct_size < min_problem_size || (options != nullptr && options->struct_size < min_options_size)
+        || (result != nullptr && result->struct_size < min_result_size))
+        return fail(NEWTON_OPT_INVALID_ARGUMENT, "struct_size of the problem, the options and the result must be set to their sizeof.");
+
+    // The caller's structures may be older and shorter than the library's: fields past them keep their defaults.
+    newton_opt_problem task = {};
+    task.struct_size = sizeof(newton_opt_problem);
+    copy_fields(*problem, task, problem->struct_size);
+    if (task.dim <= 0 || task.objective == nullptr || task.lower == nullptr || task.upper == nullptr)
+        return fail(NEWTON_OPT_INVALID_ARGUMENT, "Problem must have a positive dimension, an objective and bounds.");
+
+    newton_opt_options settings;
+    fill_defaults(settings);
+    if (options != nullptr)
+        copy_fields(*options, settings, options->struct_size);
+    if (settings.max_iter <= 0)
+        return fail(NEWTON_OPT_INVALID_ARGUMENT, "Maximum number of iterations must be positive.");
+
+    int dim = task.dim;
+    std::vector<double> start(x_0, x_0 + dim);
+    std::vector<std::pair<double, double>> box(dim);
+    for (int i = 0; i < dim; ++i) {
+        box[i] = std::make_pair(task.lower[i], task.upper[i]);
+        if (!(box[i].first <= start[i] && start[i] <= box[i].second))
+            return fail(NEWTON_OPT_INVALID_ARGUMENT, "Start point is not in the area.");
+    }
+
+    try {
+        Function* function = new Callback_function(task);
+        std::unique_ptr<Optimization_method> method;
+        switch (settings.method) {
+        case NEWTON_OPT_NEWTON:
+            method.reset(new Newton_opt(function, start, Area(box), new Criterion_grad_f(settings.eps, settings.max_iter)));
+            break;
+        case NEWTON_OPT_RANDOM_SEARCH:
+            method.reset(new Random_search(function, start, Area(box), new Criterion_max_iter(settings.max_iter),
+                settings.p, settings.delta, settings.alpha));
+            break;
+        case NEWTON_OPT_CMA_ES:
+        case NEWTON_OPT_DIFFERENTIAL_EVOLUTION:
+            method.reset(new Population_search(function, start, Area(box), new Criterion_max_iter(settings.max_iter),
+                settings.method == NEWTON_OPT_CMA_ES ? CMA_ES : DIFFERENTIAL_EVOLUTION,
+                settings.population_size, settings.sigma, std::max(settings.num_of_threads, 1)));
+            break;
+        default:
+            delete function;
+            return fail(NEWTON_OPT_INVALID_ARGUMENT, "Unknown optimization method.");
+        }
+
+        method->optimization();
+
+        const std::vector<double>& x_min = method->get_x();
+        std::copy(x_min.begin(), x_min.end(), x);
+        if (result != nullptr) {
+            newton_opt_result summary = {};
+            summary.struct_size = sizeof(newton_opt_result);
+            summary.f = method->get_f();
+            summary.num_of_iter = method->get_num_of_iter();
+            summary.num_of_evaluations = method->get_function()->get_num_of_evaluations();
+            copy_fields(summary, *result, result->struct_size);
+        }
+        return NEWTON_OPT_OK;
+    }
+    catch (const std::invalid_argument& e) {
+        return fail(NEWTON_OPT_INVALID_ARGUMENT, e.what());
+    }
+    catch (const std::exception& e) {
+        return fail(NEWTON_OPT_FAILED, e.what());
+    }
+    catch (...) {
+        return fail(NEWTON_OPT_FAILED, "Unknown error.");
+    }
+}
+
+const char* newton_opt_last_error(void) {
+    return last_error.c_str();
+}
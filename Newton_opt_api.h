@@ -0,0 +1,144 @@
+#pragma once
+
+/**
+ * @file Newton_opt_api.h
+ * @brief C interface of the optimization library.
+ *
+ * The header is plain C and can be included from C and C++. The objective is a function pointer over
+ * a raw array of coordinates with a user data pointer passed through unchanged; the result is written
+ * into buffers owned by the caller. No C++ exception crosses the interface: every function returns a
+ * status, and the message of the last error of the calling thread is available from
+ * newton_opt_last_error().
+ *
+ * Fields are only ever appended to the structures. Every structure starts with struct_size, which the
+ * caller sets to the sizeof of the structure it was compiled with; the library reads and writes only the
+ * fields inside that size and uses defaults for the rest, so a caller built against an older header keeps
+ * working with a later library.
+ */
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#if defined(NEWTON_OPT_EXPORTS)
+#define NEWTON_OPT_API __declspec(dllexport)
+#elif defined(NEWTON_OPT_SHARED)
+#define NEWTON_OPT_API __declspec(dllimport)
+#else
+#define NEWTON_OPT_API
+#endif
+#else
+#define NEWTON_OPT_API __attribute__((visibility("default")))
+#endif
+
+#define NEWTON_OPT_API_VERSION 2 /**< Version of the interface, incremented when fields are appended. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Objective function of one point.
+ * @param x Array of dim coordinates.
+ * @param dim Dimension of the problem.
+ * @param user_data Pointer given in the problem.
+ * @return Function value.
+ */
+typedef double (*newton_opt_objective)(const double* x, int dim, void* user_data);
+
+/**
+ * @brief Objective function of n points at once.
+ * @param x Coordinates, x[k * dim + i] is coordinate i of point k.
+ * @param n Number of points.
+ * @param dim Dimension of the problem.
+ * @param f Array of n values receiving the function values.
+ * @param user_data Pointer given in the problem.
+ */
+typedef void (*newton_opt_batch_objective)(const double* x, int n, int dim, double* f, void* user_data);
+
+/**
+ * @brief Optimization method.
+ */
+typedef enum {
+    NEWTON_OPT_NEWTON = 1, /**< Newton's method, stops when the norm of the gradient is below eps. */
+    NEWTON_OPT_RANDOM_SEARCH = 2, /**< Random search, stops after max_iter iterations. */
+    NEWTON_OPT_CMA_ES = 3, /**< CMA-ES, stops after max_iter generations. */
+    NEWTON_OPT_DIFFERENTIAL_EVOLUTION = 4 /**< Differential evolution, stops after max_iter generations. */
+} newton_opt_method;
+
+/**
+ * @brief Status returned by the functions of the interface.
+ */
+typedef enum {
+    NEWTON_OPT_OK = 0, /**< Success. */
+    NEWTON_OPT_INVALID_ARGUMENT = 1, /**< An argument is null or out of range. */
+    NEWTON_OPT_FAILED = 2 /**< The optimization failed, e.g. the objective threw or memory ran out. */
+} newton_opt_status;
+
+/**
+ * @brief Problem to be minimized.
+ */
+typedef struct {
+    size_t struct_size; /**< sizeof(newton_opt_problem) as compiled by the caller. */
+    int dim; /**< Dimension of the problem. */
+    newton_opt_objective objective; /**< Objective of one point, must not be null. */
+    newton_opt_batch_objective batch_objective; /**< Objective of many points, null if there is none. */
+    void* user_data; /**< Pointer passed to the objectives. */
+    const double* lower; /**< Array of dim lower bounds of the area. */
+    const double* upper; /**< Array of dim upper bounds of the area. */
+} newton_opt_problem;
+
+/**
+ * @brief Settings of a run.
+ */
+typedef struct {
+    size_t struct_size; /**< sizeof(newton_opt_options) as compiled by the caller, set before newton_opt_default_options(). */
+    int method; /**< newton_opt_method of the run. */
+    double eps; /**< Tolerance of the gradient norm of Newton's method. */
+    int max_iter; /**< Maximum number of iterations or generations. */
+    double p; /**< Probability of a global step of the random search. */
+    double delta; /**< Initial radius of the local steps of the random search. */
+    double alpha; /**< Factor shrinking the radius of the random search. */
+    int population_size; /**< Population size, 0 for the default of the strategy. */
+    double sigma; /**< Initial step size of CMA-ES, 0 for 0.3 of the mean width of the area. */
+    int num_of_threads; /**< Threads evaluating a population; above 1 the objectives must be thread-safe. */
+} newton_opt_options;
+
+/**
+ * @brief Summary of a finished run.
+ */
+typedef struct {
+    size_t struct_size; /**< sizeof(newton_opt_result) as compiled by the caller. */
+    double f; /**< Function value at the result point. */
+    int num_of_iter; /**< Number of iterations made. */
+    long long num_of_evaluations; /**< Number of objective evaluations. */
+} newton_opt_result;
+
+/**
+ * @brief Fills the options with the defaults: Newton's method, eps 1e-6, 100 iterations.
+ * Only the fields inside options->struct_size are written.
+ * @param options Options to be filled, with struct_size set by the caller.
+ * @return NEWTON_OPT_OK, or NEWTON_OPT_INVALID_ARGUMENT if options is null or struct_size is too small.
+ */
+NEWTON_OPT_API int newton_opt_default_options(newton_opt_options* options);
+
+/**
+ * @brief Minimizes the objective of a problem.
+ * @param problem Problem to be minimized, with struct_size set by the caller.
+ * @param x_0 Array of dim coordinates of the start point, which must lie in the area.
+ * @param options Settings of the run with struct_size set by the caller, null for the defaults.
+ * @param x Array of dim values receiving the result point.
+ * @param result Summary of the run with struct_size set by the caller, may be null.
+ * @return NEWTON_OPT_OK or the error status.
+ */
+NEWTON_OPT_API int newton_opt_minimize(const newton_opt_problem* problem, const double* x_0,
+    const newton_opt_options* options, double* x, newton_opt_result* result);
+
+/**
+ * @brief Getter for the message of the last error of the calling thread.
+ * @return Message, empty if the last call succeeded; valid until the next call on the thread.
+ */
+NEWTON_OPT_API const char* newton_opt_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,9 @@
 #include "Stop_criterion.h"
 #include "Newton_opt.h"
 #include "Random_search.h"
+#include "Auto_tuner.h"
+#include <random>
+#include <string>
 
 enum FunctionType {
     FUNC_1 = 1,
@@ -28,6 +31,12 @@ Function* createFunction(int functionType) {
     }
 }
 
+Stop_criterion* createProfileCriterion(const Solver_profile& profile, double eps) {
+    if (profile.method == TUNED_NEWTON)
+        return new Criterion_grad_f(eps);
+    return new Criterion_f_difference_min(eps);
+}
+
 int main() {
     setlocale(LC_ALL, "Rus");
 
@@ -89,7 +98,9 @@ int main() {
         try {
             std::cout << " Выберите метод оптимизации:\n"
                 << " 1) Метод Ньютона (backtraking);\n"
-                << " 2) Случайный поиск.\n";
+                << " 2) Случайный поиск;\n"
+                << " 3) Автоподбор метода и параметров;\n"
+                << " 4) Метод и параметры из файла профиля.\n";
 
             std::cin >> optimization_method_int;
 
@@ -191,13 +202,60 @@ int main() {
                 break;
 
 
+            case 3:
+            case 4: {
+                Solver_profile profile;
+                std::string path;
+                try {
+                    std::cout << "Введите значение eps: ";
+                    std::cin >> eps;
+                    std::cout << "Введите имя файла профиля: ";
+                    std::cin >> path;
+
+                    if (optimization_method_int == 3) {
+                        double target_f;
+                        std::cout << "Введите целевое значение функции: ";
+                        std::cin >> target_f;
+
+                        // Probe problems start at the given point and at random points of the area.
+                        std::vector<std::vector<double>> starts(1, x_0);
+                        std::mt19937 generator(0);
+                        std::uniform_real_distribution<double> distribution(0, 1);
+                        for (int k = 0; k < 7; ++k) {
+                            std::vector<double> start(dim);
+                            for (int i = 0; i < dim; ++i) {
+                                start[i] = box[i].first + distribution(generator) * (box[i].second - box[i].first);
+                            }
+                            starts.push_back(start);
+                        }
+
+                        Auto_tuner tuner([function_nt]() { return createFunction(function_nt); }, area, starts, target_f, eps);
+                        profile = tuner.run();
+                        Auto_tuner::save_profile(profile, path);
+                        std::cout << " Промахов: " << profile.num_of_failures << " из " << starts.size()
+                            << ", вычислений функции: " << profile.cost << std::endl;
+                    }
+                    else {
+                        profile = Auto_tuner::load_profile(path);
+                    }
+                }
+                catch (const std::exception& e) {
+                    std::cout << " " << e.what() << std::endl;
+                    return -1;
+                }
+
+                std::cout << (profile.method == TUNED_NEWTON ? " Метод Ньютона" : " Случайный поиск") << std::endl;
+                optimization_method = Auto_tuner::create_method(profile, function.get(), x_0, area, createProfileCriterion(profile, eps));
+                break;
+            }
+
             default:
-                throw std::invalid_argument("Введено недопустимое значение. Необходимо ввести 1 или 2.");
+                throw std::invalid_argument("Введено недопустимое значение. Необходимо ввести число от 1 до 4.");
                 break;
             }
         }
         catch (const std::exception& e) {
-            std::cout << " Введено недопустимое значение. Необходимо ввести число 1 или 2." << std::endl;
+            std::cout << " Введено недопустимое значение. Необходимо ввести число от 1 до 4." << std::endl;
             return -1;
         }
 
@@ -1,18 +1,24 @@
 #include "Optimization_method.h"
 #include "Function.h"
 #include "Stop_criterion.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
 
-Optimization_method::Optimization_method(){}
+Optimization_method::Optimization_method() : num_of_saved(0), is_resumed(false), trajectory(nullptr), control(nullptr), finite_difference(nullptr),
+    step_ratio(0.1), is_mixed_precision(false), is_single_phase(false), is_single_exhausted(false) {}
 
 Optimization_method::~Optimization_method() {
     delete function;
     delete stop_criterion;
+    delete finite_difference;
 }
 
 Optimization_method::Optimization_method(Function* func, std::vector<double> x_0, Area area_, Stop_criterion* stop_crit_) :
-    function(func), area(area_), stop_criterion(stop_crit_), num_of_iter(0), num_of_iter_since_last_approx(0) {
+    function(func), area(area_), stop_criterion(stop_crit_), num_of_iter(0), num_of_iter_since_last_approx(0), num_of_saved(0), is_resumed(false), trajectory(nullptr), control(nullptr), finite_difference(nullptr),
+    step_ratio(0.1), is_mixed_precision(false), is_single_phase(false), is_single_exhausted(false) {
     seq_x_i.push_back(x_0);
-    seq_f_i.push_back(function->calculate(x_0));
+    seq_f_i.push_back(function->evaluate(x_0));
 }
 
 std::vector<std::vector<double>> Optimization_method::get_seq_x_i() {
@@ -23,6 +29,94 @@ std::vector<double> Optimization_method::get_seq_f_i() {
     return seq_f_i;
 }
 
+const std::vector<double>& Optimization_method::get_x() {
+    return seq_x_i.back();
+}
+
+double Optimization_method::get_f() {
+    return seq_f_i.back();
+}
+
+std::vector<double> Optimization_method::gradient(const std::vector<double>& x) {
+    if (x == grad_point && !grad_value.empty())
+        return grad_value;
+    TRACE_SCOPE("gradient");
+
+    if (is_single_phase && !function->has_analytic_derivatives()) {
+        grad_value = function->gradient_single(x, area);
+        double norm = 0;
+        for (double g : grad_value) {
+            norm += g * g;
+        }
+        double floor = std::max(stop_criterion->get_eps(), std::sqrt(FLT_EPSILON) * std::max(std::fabs(seq_f_i.back()), 1.0));
+        if (std::sqrt(norm) > floor) {
+            grad_point = x;
+            return grad_value;
+        }
+        // The method leaves the single phase in its own loop; this gradient is already recalculated in double.
+        is_single_exhausted = true;
+    }
+
+    if (finite_difference && !function->has_analytic_derivatives())
+        grad_value = finite_difference->gradient(function, x, area);
+    else
+        grad_value = function->gradient(x, stop_criterion->get_eps() * step_ratio, area);
+    grad_point = x;
+    return grad_value;
+}
+
+std::vector<std::vector<double>> Optimization_method::hessian(const std::vector<double>& x) {
+    TRACE_SCOPE("hessian");
+    if (is_single_phase && !is_single_exhausted && !function->has_analytic_derivatives())
+        return function->hessian_single(x, area);
+    if (finite_difference && !function->has_analytic_derivatives())
+        return finite_difference->hessian(function, x, area);
+    return function->hessian(x, stop_criterion->get_eps() * step_ratio, area);
+}
+
+void Optimization_method::set_finite_difference(Finite_difference* finite_difference_) {
+    delete finite_difference;
+    finite_difference = finite_difference_;
+    grad_point.clear();
+    grad_value.clear();
+}
+
+void Optimization_method::set_step_ratio(double step_ratio_) {
+    if (!(step_ratio_ > 0))
+        throw std::invalid_argument("Step ratio must be positive.");
+    step_ratio = step_ratio_;
+    grad_point.clear();
+    grad_value.clear();
+}
+
+double Optimization_method::get_step_ratio() {
+    return step_ratio;
+}
+
+void Optimization_method::set_mixed_precision(bool is_mixed_precision_) {
+    is_mixed_precision = is_mixed_precision_;
+}
+
+bool Optimization_method::get_is_single_phase() {
+    return is_single_phase;
+}
+
+void Optimization_method::leave_single_precision() {
+    if (!is_single_phase)
+        return;
+
+    is_single_phase = false;
+    is_single_exhausted = false;
+    // Replaces the float values in place: a new entry would look like an iteration to the stopping criteria.
+    // The criteria compare the last two values, so neither may stay in single precision.
+    int size = static_cast<int>(seq_f_i.size());
+    for (int k = std::max(size - 2, 0); k < size; ++k) {
+        seq_f_i[k] = function->evaluate(seq_x_i[k]);
+    }
+    grad_point.clear();
+    grad_value.clear();
+}
+
 Function* Optimization_method::get_function() {
     return function;
 }
@@ -42,3 +136,154 @@ int Optimization_method::get_num_of_iter() {
 int Optimization_method::get_num_of_iter_since_last_approx() {
     return num_of_iter_since_last_approx;
 }
+
+void Optimization_method::set_run_control(Run_control* control_) {
+    control = control_;
+    if (control)
+        function->set_interrupt([this]() { return is_interrupted(); });
+    else
+        function->set_interrupt(nullptr);
+}
+
+bool Optimization_method::is_finished() {
+    TRACE_SCOPE("termination check");
+    if (stop_criterion->termination(this)) {
+        if (control)
+            control->set_stop_reason(STOP_CRITERION);
+        return true;
+    }
+    return control && control->check(this);
+}
+
+bool Optimization_method::is_interrupted() {
+    return control && control->is_interrupted(this);
+}
+
+void Optimization_method::adopt(const std::vector<double>& x, double f) {
+    if (!(f < seq_f_i.back()) || !area.is_inside(x))
+        return;
+
+    seq_x_i.push_back(x);
+    seq_f_i.push_back(f);
+    num_of_iter_since_last_approx = 0;
+    record_point(x, f, num_of_iter, true);
+}
+
+void Optimization_method::set_trajectory(Trajectory_writer* trajectory_) {
+    if (trajectory_ != nullptr && trajectory_->get_dim() != function->get_dim())
+        throw std::invalid_argument("Trajectory dimension does not match the function.");
+
+    trajectory = trajectory_;
+    record_point(seq_x_i.back(), seq_f_i.back(), num_of_iter, true);
+}
+
+void Optimization_method::record_point(const std::vector<double>& x, double f, int iter, bool accepted) {
+    if (trajectory != nullptr)
+        trajectory->record(x.data(), f, iter, accepted);
+}
+
+void Optimization_method::set_checkpoint(const std::string& path, int interval) {
+    checkpoint.reset(new Checkpoint(path, interval));
+    num_of_saved = 0;
+}
+
+void Optimization_method::checkpoint_if_due() {
+    if (!checkpoint || !checkpoint->is_due(num_of_iter))
+        return;
+    TRACE_SCOPE("checkpoint");
+    write_checkpoint(false);
+}
+
+void Optimization_method::checkpoint_on_finish() {
+    if (!checkpoint || !checkpoint->is_enabled())
+        return;
+    write_checkpoint(true);
+}
+
+void Optimization_method::write_checkpoint(bool is_final) {
+    std::ostringstream out(std::ios::binary);
+    save_state(out);
+
+    // Everything but the last two iterates, which save_state writes itself.
+    int dim = function->get_dim();
+    size_t size = seq_f_i.size(), num_of_history = size - std::min<size_t>(size, 2);
+    std::ostringstream history(std::ios::binary);
+    for (size_t k = num_of_saved; k < num_of_history; ++k) {
+        history.write(reinterpret_cast<const char*>(seq_x_i[k].data()), dim * sizeof(double));
+        Checkpoint::write_value<double>(history, seq_f_i[k]);
+    }
+    uint64_t history_offset = num_of_saved * (dim + 1) * sizeof(double);
+    num_of_saved = std::max(num_of_saved, num_of_history);
+
+    if (is_final)
+        checkpoint->write(out.str(), history.str(), history_offset);
+    else
+        checkpoint->write_async(out.str(), history.str(), history_offset, num_of_iter);
+}
+
+void Optimization_method::resume(const std::string& path) {
+    std::istringstream in(Checkpoint::read_file(path), std::ios::binary);
+    load_state(in);
+
+    // load_state restores the last iterates and leaves the number of earlier ones in num_of_saved.
+    if (num_of_saved > 0) {
+        int dim = function->get_dim();
+        std::istringstream history(Checkpoint::read_file(Checkpoint::history_path(path)), std::ios::binary);
+        std::vector<std::vector<double>> x(num_of_saved, std::vector<double>(dim));
+        std::vector<double> f(num_of_saved);
+        for (size_t k = 0; k < num_of_saved; ++k) {
+            if (!history.read(reinterpret_cast<char*>(x[k].data()), dim * sizeof(double)))
+                throw std::runtime_error("Checkpoint history file is truncated.");
+            f[k] = Checkpoint::read_value<double>(history);
+        }
+        seq_x_i.insert(seq_x_i.begin(), x.begin(), x.end());
+        seq_f_i.insert(seq_f_i.begin(), f.begin(), f.end());
+    }
+    // A checkpoint written to another file starts its history from the beginning.
+    if (!checkpoint || checkpoint->get_path() != path)
+        num_of_saved = 0;
+    is_resumed = true;
+}
+
+void Optimization_method::save_state(std::ostream& out) {
+    int dim = function->get_dim();
+    size_t size = seq_f_i.size(), num_of_kept = std::min<size_t>(size, 2);
+    Checkpoint::write_value<uint32_t>(out, 0x54504F4E); // "NOPT"
+    Checkpoint::write_value<uint32_t>(out, 3);
+    Checkpoint::write_value<int32_t>(out, dim);
+    Checkpoint::write_value<int32_t>(out, num_of_iter);
+    Checkpoint::write_value<int32_t>(out, num_of_iter_since_last_approx);
+    Checkpoint::write_value<uint64_t>(out, size - num_of_kept);
+    Checkpoint::write_value<uint64_t>(out, num_of_kept);
+    for (size_t k = size - num_of_kept; k < size; ++k) {
+        out.write(reinterpret_cast<const char*>(seq_x_i[k].data()), dim * sizeof(double));
+    }
+    out.write(reinterpret_cast<const char*>(seq_f_i.data() + size - num_of_kept), num_of_kept * sizeof(double));
+}
+
+void Optimization_method::load_state(std::istream& in) {
+    // Older versions lack the history file or the fields derived classes have appended since.
+    if (Checkpoint::read_value<uint32_t>(in) != 0x54504F4E || Checkpoint::read_value<uint32_t>(in) != 3)
+        throw std::runtime_error("Unsupported checkpoint format.");
+
+    int dim = Checkpoint::read_value<int32_t>(in);
+    if (dim != function->get_dim())
+        throw std::runtime_error("Checkpoint dimension does not match the function.");
+
+    num_of_iter = Checkpoint::read_value<int32_t>(in);
+    num_of_iter_since_last_approx = Checkpoint::read_value<int32_t>(in);
+    uint64_t num_of_history = Checkpoint::read_value<uint64_t>(in);
+    uint64_t size = Checkpoint::read_value<uint64_t>(in);
+    if (size < 1 || size > 2 || (num_of_history > 0 && size < 2))
+        throw std::runtime_error("Checkpoint is corrupted.");
+    num_of_saved = num_of_history;
+
+    seq_x_i.assign(size, std::vector<double>(dim));
+    seq_f_i.resize(size);
+    for (size_t k = 0; k < size; ++k) {
+        if (!in.read(reinterpret_cast<char*>(seq_x_i[k].data()), dim * sizeof(double)))
+            throw std::runtime_error("Checkpoint file is truncated.");
+    }
+    if (!in.read(reinterpret_cast<char*>(seq_f_i.data()), size * sizeof(double)))
+        throw std::runtime_error("Checkpoint file is truncated.");
+}
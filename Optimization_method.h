@@ -3,11 +3,18 @@
 #include "Function.h"
 #include "Stop_criterion.h"
 #include "Area.h"
+#include "Checkpoint.h"
+#include "Trajectory.h"
+#include "Run_control.h"
+#include "Finite_difference.h"
+#include "Trace.h"
 #include <iostream>
 #include <vector>
 #include <random>
 #include <chrono>
 #include <sstream>
+#include <memory>
+#include <string>
 
 /**
  * @brief Base class representing an optimization method.
@@ -21,6 +28,76 @@ protected:
     Stop_criterion* stop_criterion; /**< Pointer to the stopping criterion. */
     int num_of_iter; /**< Total number of iterations. */
     int num_of_iter_since_last_approx; /**< Number of iterations since the last approximation. */
+    size_t num_of_saved; /**< Number of earliest iterates already in the history file of the checkpoint. */
+    std::unique_ptr<Checkpoint> checkpoint; /**< Checkpoint writer, null if checkpoints are disabled. */
+    bool is_resumed; /**< True if the state was restored from a checkpoint and the next optimization continues it. */
+    Trajectory_writer* trajectory; /**< Sink receiving every evaluated point, null if the trajectory is not recorded. */
+    Run_control* control; /**< Control of the run, null if the run is not controlled. */
+    Finite_difference* finite_difference; /**< Engine with adaptive steps, null if the fixed step step_ratio * eps is used. */
+    double step_ratio; /**< Fixed finite-difference step as a fraction of the tolerance of the stopping criterion. */
+    std::vector<double> grad_point; /**< Point of the last calculated gradient. */
+    std::vector<double> grad_value; /**< Last calculated gradient. */
+    bool is_mixed_precision; /**< True if the optimization starts in single precision. */
+    bool is_single_phase; /**< True while the function is evaluated in single precision. */
+    bool is_single_exhausted; /**< True once single precision derivatives no longer resolve the progress; the method must leave the single phase. */
+
+    /**
+     * @brief Switches from single to double precision and re-evaluates the last two points, the ones the stopping criteria read, in double precision.
+     */
+    void leave_single_precision();
+
+    /**
+     * @brief Checks the stopping criterion and the run control. Called once per iteration.
+     * @return True if the optimization must stop, false otherwise.
+     */
+    bool is_finished();
+
+    /**
+     * @brief Checks cancellation and the limits of the run control without reporting progress.
+     * Used inside long steps of an iteration; records the stop reason like is_finished().
+     * @return True if the optimization must stop, false otherwise.
+     */
+    bool is_interrupted();
+
+    /**
+     * @brief Passes an evaluated point to the trajectory sink, if one is set.
+     * @param x Evaluated point.
+     * @param f Function value at the point.
+     * @param iter Iteration at which the point was evaluated.
+     * @param accepted True if the point became the next iterate.
+     */
+    void record_point(const std::vector<double>& x, double f, int iter, bool accepted);
+
+    /**
+     * @brief Writes a checkpoint if one is due at the current iteration.
+     */
+    void checkpoint_if_due();
+
+    /**
+     * @brief Writes the final state to the checkpoint file once the optimization has finished.
+     */
+    void checkpoint_on_finish();
+
+    /**
+     * @brief Writes the state and the iterates new since the previous checkpoint.
+     * @param is_final True to wait until the checkpoint is on disk, false to write it in the background.
+     */
+    void write_checkpoint(bool is_final);
+
+    /**
+     * @brief Serializes the state of the optimization method.
+     * The last two iterates, whose values leave_single_precision may still replace, are written here;
+     * the earlier ones go to the history file of the checkpoint, so a checkpoint costs only the
+     * iterates added since the previous one. Derived classes extend it with their own parameters.
+     * @param out Output stream.
+     */
+    virtual void save_state(std::ostream& out);
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    virtual void load_state(std::istream& in);
 
 public:
     /**
@@ -30,7 +107,7 @@ public:
 
     /**
       * @brief Destructor for optimization method.
-      * Deletes the function and stop criterion objects.
+      * Deletes the function, stop criterion and finite-difference objects.
       */
     virtual ~Optimization_method();
 
@@ -55,6 +132,73 @@ public:
      */
     std::vector<double> get_seq_f_i();
 
+    /**
+     * @brief Getter for the current iterate.
+     * @return Last point of the sequence of iterates.
+     */
+    const std::vector<double>& get_x();
+
+    /**
+     * @brief Getter for the current function value.
+     * @return Last value of the sequence of function values.
+     */
+    double get_f();
+
+    /**
+     * @brief Calculates the gradient of the objective function.
+     * Uses the analytic derivatives of the function if it has them, otherwise the adaptive engine
+     * if it is set and the fixed step step_ratio * eps otherwise.
+     * In the single precision phase the gradient is calculated in float; once its norm falls to
+     * max(eps, sqrt(FLT_EPSILON) * max(|f|, 1)) it is recalculated in double and is_single_exhausted is set;
+     * the method itself then leaves the single phase.
+     * The gradient at the last point is cached, so the stopping criterion and the method share it.
+     * @param x Point at which the gradient is calculated.
+     * @return Gradient vector.
+     */
+    std::vector<double> gradient(const std::vector<double>& x);
+
+    /**
+     * @brief Calculates the Hessian matrix of the objective function.
+     * Uses the analytic derivatives of the function if it has them, otherwise the adaptive engine
+     * if it is set and the fixed step step_ratio * eps otherwise.
+     * @param x Point at which the Hessian is calculated.
+     * @return Hessian matrix.
+     */
+    std::vector<std::vector<double>> hessian(const std::vector<double>& x);
+
+    /**
+     * @brief Sets the engine computing derivatives with adaptive steps.
+     * @param finite_difference_ Pointer to the engine, owned by the method afterwards, or null for the fixed step.
+     */
+    void set_finite_difference(Finite_difference* finite_difference_);
+
+    /**
+     * @brief Sets the fixed finite-difference step used without the adaptive engine.
+     * @param step_ratio_ Step as a fraction of the tolerance of the stopping criterion, 0.1 by default.
+     */
+    void set_step_ratio(double step_ratio_);
+
+    /**
+     * @brief Getter for the fixed finite-difference step ratio.
+     * @return Step as a fraction of the tolerance of the stopping criterion.
+     */
+    double get_step_ratio();
+
+    /**
+     * @brief Enables the mixed precision mode.
+     * The early phase of the optimization evaluates the function in single precision (see Function::evaluate_single);
+     * the method switches to double precision once single precision can no longer resolve its progress, so the
+     * final accuracy is that of an all-double run. Derivatives of the single phase use steps suited to float.
+     * @param is_mixed_precision_ If true, the next optimization starts in single precision.
+     */
+    void set_mixed_precision(bool is_mixed_precision_);
+
+    /**
+     * @brief Checks whether the method currently evaluates in single precision.
+     * @return True during the single precision phase, false otherwise.
+     */
+    bool get_is_single_phase();
+
     /**
      * @brief Getter for the pointer to the objective function.
      * @return Pointer to the objective function.
@@ -85,6 +229,44 @@ public:
      */
     int get_num_of_iter_since_last_approx();
 
+    /**
+     * @brief Sets the control checked by the method once per iteration.
+     * The control is not owned by the method. It is also checked between the columns of
+     * finite-difference Hessians of the function.
+     * @param control_ Run control, or null to run without control.
+     */
+    void set_run_control(Run_control* control_);
+
+    /**
+     * @brief Enables periodic checkpoints of the optimization state.
+     * @param path Path of the checkpoint file.
+     * @param interval Number of iterations between two checkpoints.
+     */
+    void set_checkpoint(const std::string& path, int interval);
+
+    /**
+     * @brief Continues the optimization from a point found elsewhere, e.g. by another run.
+     * The point is appended to the sequence of iterates if it is inside the area and better than the current one.
+     * @param x Point to continue from.
+     * @param f Function value at the point.
+     */
+    virtual void adopt(const std::vector<double>& x, double f);
+
+    /**
+     * @brief Sets the sink that receives every point evaluated by the method.
+     * The current iterate is recorded immediately. The sink is not owned by the method.
+     * @param trajectory_ Trajectory writer, or null to stop recording.
+     */
+    void set_trajectory(Trajectory_writer* trajectory_);
+
+    /**
+     * @brief Restores the optimization state from a checkpoint file.
+     * The next call of optimization() continues the interrupted run. The sequences of iterates
+     * are read back whole, the earlier part from the history file next to the checkpoint.
+     * @param path Path of the checkpoint file.
+     */
+    void resume(const std::string& path);
+
     /**
      * @brief Pure virtual function for performing the optimization.
      */
@@ -0,0 +1,90 @@
+#include "Parametric_sweep.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+Parametric_sweep::Parametric_sweep(Function_family function_family_, Area_family area_family_, double eps_, int max_num_of_iterations_)
+    : function_family(function_family_), area_family(area_family_), eps(eps_), max_num_of_iterations(max_num_of_iterations_),
+    max_hessian_reuse(4), is_extrapolating(true) {
+    if (!function_family || !area_family)
+        throw std::invalid_argument("Function and area families must be set.");
+}
+
+void Parametric_sweep::set_hessian_reuse(int max_hessian_reuse_) {
+    max_hessian_reuse = std::max(max_hessian_reuse_, 1);
+}
+
+void Parametric_sweep::set_extrapolation(bool is_extrapolating_) {
+    is_extrapolating = is_extrapolating_;
+}
+
+std::vector<Sweep_point> Parametric_sweep::run(const std::vector<double>& parameters, const std::vector<double>& x_0) {
+    std::vector<Sweep_point> result;
+    Eigen::MatrixXd inverse_hessian_matrix;
+
+    for (double parameter : parameters) {
+        Function* function = function_family(parameter);
+        if (function == nullptr)
+            throw std::runtime_error("Function family returned no function.");
+        std::unique_ptr<Function> owner(function);
+        Area area = area_family(parameter);
+        std::vector<std::pair<double, double>> box = area.get_box();
+        int dim = function->get_dim();
+
+        // Start point: the previous minimum, or the point extrapolated along the path if it is lower.
+        std::vector<double> start = result.empty() ? x_0 : result.back().x;
+        for (int i = 0; i < dim && i < static_cast<int>(box.size()); ++i) {
+            start[i] = std::min(std::max(start[i], box[i].first), box[i].second);
+        }
+        double start_f = function->evaluate(start);
+
+        // Lagrange extrapolation through the last (up to three) minima; it needs distinct parameters.
+        int n = static_cast<int>(result.size()), q = std::min(n, 3);
+        bool is_distinct = q >= 2;
+        for (int a = n - q; a < n; ++a) {
+            for (int b = n - q; b < a; ++b) {
+                is_distinct = is_distinct && result[a].parameter != result[b].parameter;
+            }
+        }
+        if (is_extrapolating && is_distinct) {
+            std::vector<double> predicted(dim, 0);
+            for (int a = n - q; a < n; ++a) {
+                double weight = 1;
+                for (int b = n - q; b < n; ++b) {
+                    if (b != a)
+                        weight *= (parameter - result[b].parameter) / (result[a].parameter - result[b].parameter);
+                }
+                for (int i = 0; i < dim; ++i) {
+                    predicted[i] += weight * result[a].x[i];
+                }
+            }
+            for (int i = 0; i < dim && i < static_cast<int>(box.size()); ++i) {
+                predicted[i] = std::min(std::max(predicted[i], box[i].first), box[i].second);
+            }
+            double predicted_f = function->evaluate(predicted);
+            if (predicted_f < start_f)
+                start = predicted;
+        }
+
+        owner.release();
+        Newton_opt method(function, start, area, new Criterion_grad_f(eps, max_num_of_iterations));
+        method.set_hessian_reuse(max_hessian_reuse, 0.5, true);
+        if (inverse_hessian_matrix.rows() == dim)
+            method.warm_start(inverse_hessian_matrix);
+        method.optimization();
+
+        if (method.get_inverse_hessian().rows() == dim && method.get_inverse_hessian().allFinite())
+            inverse_hessian_matrix = method.get_inverse_hessian();
+
+        Sweep_point point;
+        point.parameter = parameter;
+        point.x = method.get_x();
+        point.f = method.get_f();
+        point.num_of_iter = method.get_num_of_iter();
+        point.num_of_hessians = method.get_num_of_hessians();
+        point.num_of_evaluations = function->get_num_of_evaluations();
+        result.push_back(point);
+    }
+    return result;
+}
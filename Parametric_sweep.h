@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Newton_opt.h"
+#include <functional>
+#include <vector>
+#include <Eigen/Dense>
+
+/**
+ * @brief Solution of one problem of a sweep.
+ */
+struct Sweep_point {
+    double parameter; /**< Parameter of the problem. */
+    std::vector<double> x; /**< Minimum found. */
+    double f; /**< Function value at the minimum. */
+    int num_of_iter; /**< Number of Newton steps. */
+    int num_of_hessians; /**< Number of calculated Hessian matrices. */
+    long long num_of_evaluations; /**< Number of function evaluations, including the choice of the start point. */
+};
+
+/**
+ * @brief Continuation method solving a sequence of related problems with Newton's method.
+ *
+ * The problems are given by a family of objective functions and areas depending on a scalar parameter.
+ * Every solve after the first starts from a point extrapolated through the last three minima
+ * (or from the last minimum, whichever is lower) and with the inverse Hessian matrix of the previous
+ * solve, corrected by BFGS updates and refreshed only when convergence slows down. When the parameter
+ * changes slowly, a problem needs one or two Newton steps and no new Hessian matrix.
+ */
+class Parametric_sweep {
+public:
+    typedef std::function<Function*(double parameter)> Function_family; /**< Creates the objective of a parameter. */
+    typedef std::function<Area(double parameter)> Area_family; /**< Gives the area of a parameter. */
+
+private:
+    Function_family function_family; /**< Family of objective functions. */
+    Area_family area_family; /**< Family of areas. */
+    double eps; /**< Tolerance of the gradient norm. */
+    int max_num_of_iterations; /**< Maximum number of Newton steps of a problem. */
+    int max_hessian_reuse; /**< Maximum number of iterations using the same inverse Hessian matrix. */
+    bool is_extrapolating; /**< True if start points are extrapolated along the path. */
+
+public:
+    /**
+     * @brief Constructor for the sweep.
+     * @param function_family_ Function creating the objective of a parameter; the sweep deletes the objects.
+     * @param area_family_ Function giving the area of a parameter.
+     * @param eps_ Tolerance of the gradient norm.
+     * @param max_num_of_iterations_ Maximum number of Newton steps of a problem.
+     */
+    Parametric_sweep(Function_family function_family_, Area_family area_family_, double eps_, int max_num_of_iterations_ = 100);
+
+    /**
+     * @brief Sets how long an inverse Hessian matrix is kept, see Newton_opt::set_hessian_reuse.
+     * @param max_hessian_reuse_ Maximum number of iterations using the same inverse, 1 refreshes it every iteration.
+     */
+    void set_hessian_reuse(int max_hessian_reuse_);
+
+    /**
+     * @brief Enables or disables the extrapolation of the start points.
+     * @param is_extrapolating_ If false, every problem starts from the previous minimum.
+     */
+    void set_extrapolation(bool is_extrapolating_);
+
+    /**
+     * @brief Solves the problems of the given parameters in order.
+     * @param parameters Parameters of the problems, changing monotonically and slowly for the best effect.
+     * @param x_0 Start point of the first problem.
+     * @return Solution of every problem.
+     */
+    std::vector<Sweep_point> run(const std::vector<double>& parameters, const std::vector<double>& x_0);
+};
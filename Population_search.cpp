@@ -0,0 +1,324 @@
+#include "Population_search.h"
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    void write_matrix(std::ostream& out, const Eigen::MatrixXd& m) {
+        Checkpoint::write_value<int64_t>(out, m.rows());
+        Checkpoint::write_value<int64_t>(out, m.cols());
+        out.write(reinterpret_cast<const char*>(m.data()), m.size() * sizeof(double));
+    }
+
+    template <typename T>
+    void read_matrix(std::istream& in, T& m) {
+        int64_t rows = Checkpoint::read_value<int64_t>(in);
+        int64_t cols = Checkpoint::read_value<int64_t>(in);
+        m.resize(rows, cols);
+        if (!in.read(reinterpret_cast<char*>(m.data()), m.size() * sizeof(double)))
+            throw std::runtime_error("Checkpoint file is truncated.");
+    }
+}
+
+Population_search::Population_search(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+    Population_strategy strategy_, int population_size_, double sigma_, int num_of_threads)
+    : Optimization_method(function, x_0, area, stop_criterion), strategy(strategy_), population_size(population_size_),
+    seed(static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count())), generator(seed),
+    has_spare_normal(false), spare_normal(0), box(area.get_box()), pool(new Thread_pool(num_of_threads)),
+    sigma(sigma_), eigen_iter(0), de_f(0.8), de_cr(0.9) {
+    int dim = function->get_dim();
+
+    for (int t = 0; t < pool->get_num_of_threads(); ++t) {
+        Function* clone = function->clone();
+        if (clone == nullptr) {
+            for (Function* c : clones) {
+                delete c;
+            }
+            clones.clear();
+            break;
+        }
+        clones.push_back(clone);
+    }
+
+    if (strategy == CMA_ES) {
+        if (population_size <= 0)
+            population_size = 4 + static_cast<int>(3 * std::log(static_cast<double>(dim)));
+        population_size = std::max(population_size, 4);
+        if (sigma <= 0) {
+            double width = 0;
+            for (int i = 0; i < dim; ++i) {
+                width += box[i].second - box[i].first;
+            }
+            sigma = 0.3 * width / dim;
+        }
+
+        mu = population_size / 2;
+        weights.resize(mu);
+        for (int i = 0; i < mu; ++i) {
+            weights(i) = std::log(mu + 0.5) - std::log(i + 1.0);
+        }
+        weights /= weights.sum();
+        mueff = 1 / weights.squaredNorm();
+
+        double n = dim;
+        cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+        cs = (mueff + 2) / (n + mueff + 5);
+        c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff);
+        cmu = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((n + 2) * (n + 2) + mueff));
+        damps = 1 + 2 * std::max(0.0, std::sqrt((mueff - 1) / (n + 1)) - 1) + cs;
+        chi_n = std::sqrt(n) * (1 - 1 / (4 * n) + 1 / (21 * n * n));
+
+        mean = Eigen::Map<const Eigen::VectorXd>(x_0.data(), dim);
+        C = Eigen::MatrixXd::Identity(dim, dim);
+        B = Eigen::MatrixXd::Identity(dim, dim);
+        D = Eigen::VectorXd::Ones(dim);
+        pc = Eigen::VectorXd::Zero(dim);
+        ps = Eigen::VectorXd::Zero(dim);
+    }
+    else {
+        if (population_size <= 0)
+            population_size = std::max(10 * dim, 20);
+        population_size = std::max(population_size, 4);
+    }
+}
+
+Population_search::~Population_search() {
+    for (Function* clone : clones) {
+        delete clone;
+    }
+}
+
+void Population_search::set_de_parameters(double de_f_, double de_cr_) {
+    de_f = de_f_;
+    de_cr = de_cr_;
+}
+
+const Eigen::MatrixXd& Population_search::get_population() {
+    return population;
+}
+
+double Population_search::normal() {
+    if (has_spare_normal) {
+        has_spare_normal = false;
+        return spare_normal;
+    }
+
+    double u1 = 1 - generator.uniform(), u2 = generator.uniform();
+    double r = std::sqrt(-2 * std::log(u1)), phi = 2 * 3.14159265358979323846 * u2;
+    spare_normal = r * std::sin(phi);
+    has_spare_normal = true;
+    return r * std::cos(phi);
+}
+
+void Population_search::project(Eigen::MatrixXd& points) {
+    for (int k = 0; k < points.cols(); ++k) {
+        for (int i = 0; i < points.rows(); ++i) {
+            points(i, k) = std::min(std::max(points(i, k), box[i].first), box[i].second);
+        }
+    }
+}
+
+void Population_search::evaluate_points(const Eigen::MatrixXd& points, Eigen::VectorXd& values) {
+    TRACE_SCOPE("evaluate generation");
+    int n = static_cast<int>(points.cols());
+    values.resize(n);
+
+    // The columns of the matrix are the points, stored one after another as calculate_batch() expects.
+    if (clones.empty()) {
+        function->calculate_batch(points.data(), n, values.data());
+    }
+    else {
+        pool->parallel_for(n, [&](int begin, int end, int thread) {
+            TRACE_SCOPE("evaluate part");
+            clones[thread]->calculate_batch(points.col(begin).data(), end - begin, values.data() + begin);
+        });
+    }
+    function->add_num_of_evaluations(n);
+}
+
+void Population_search::update_best(const Eigen::MatrixXd& points, const Eigen::VectorXd& values) {
+    int dim = static_cast<int>(points.rows());
+    Eigen::Index best;
+    values.minCoeff(&best);
+    bool is_improved = values(best) < seq_f_i.back();
+
+    std::vector<double> x(dim);
+    if (trajectory != nullptr) {
+        for (int k = 0; k < points.cols(); ++k) {
+            std::copy(points.col(k).data(), points.col(k).data() + dim, x.begin());
+            record_point(x, values(k), num_of_iter, is_improved && k == best);
+        }
+    }
+
+    if (is_improved) {
+        std::copy(points.col(best).data(), points.col(best).data() + dim, x.begin());
+        seq_x_i.push_back(x);
+        seq_f_i.push_back(values(best));
+        num_of_iter_since_last_approx = 0;
+    }
+}
+
+void Population_search::cma_generation() {
+    int dim = function->get_dim();
+
+    // The eigendecomposition costs O(dim^3), so it is updated only every few generations.
+    if (num_of_iter - eigen_iter > population_size / ((c1 + cmu) * dim * 10)) {
+        C = (C + C.transpose()) / 2;
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(C);
+        B = solver.eigenvectors();
+        D = solver.eigenvalues().cwiseMax(1e-20).cwiseSqrt();
+        eigen_iter = num_of_iter;
+    }
+
+    Eigen::MatrixXd z(dim, population_size);
+    for (int k = 0; k < population_size; ++k) {
+        for (int i = 0; i < dim; ++i) {
+            z(i, k) = normal();
+        }
+    }
+    population = (B * D.asDiagonal() * z * sigma).colwise() + mean;
+    project(population);
+    evaluate_points(population, fitness);
+    update_best(population, fitness);
+
+    std::vector<int> order(population_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return fitness(a) < fitness(b); });
+
+    Eigen::VectorXd old_mean = mean;
+    Eigen::MatrixXd steps(dim, mu);
+    mean.setZero();
+    for (int i = 0; i < mu; ++i) {
+        mean += weights(i) * population.col(order[i]);
+        steps.col(i) = (population.col(order[i]) - old_mean) / sigma;
+    }
+    Eigen::VectorXd y_w = (mean - old_mean) / sigma;
+
+    ps = (1 - cs) * ps + std::sqrt(cs * (2 - cs) * mueff) * (B * D.cwiseInverse().asDiagonal() * B.transpose() * y_w);
+    double ps_norm = ps.norm();
+    bool hsig = ps_norm / std::sqrt(1 - std::pow(1 - cs, 2.0 * num_of_iter)) / chi_n < 1.4 + 2 / (dim + 1.0);
+    pc = (1 - cc) * pc + (hsig ? std::sqrt(cc * (2 - cc) * mueff) : 0.0) * y_w;
+
+    C = (1 - c1 - cmu) * C
+        + c1 * (pc * pc.transpose() + (hsig ? 0.0 : cc * (2 - cc)) * C)
+        + cmu * steps * weights.asDiagonal() * steps.transpose();
+    sigma *= std::exp((cs / damps) * (ps_norm / chi_n - 1));
+}
+
+void Population_search::de_generation() {
+    int dim = function->get_dim();
+    Eigen::MatrixXd trials(dim, population_size);
+
+    for (int k = 0; k < population_size; ++k) {
+        int a, b, c;
+        do { a = static_cast<int>(generator.next() % population_size); } while (a == k);
+        do { b = static_cast<int>(generator.next() % population_size); } while (b == k || b == a);
+        do { c = static_cast<int>(generator.next() % population_size); } while (c == k || c == a || c == b);
+        int j_rand = static_cast<int>(generator.next() % dim);
+
+        for (int i = 0; i < dim; ++i) {
+            if (i == j_rand || generator.uniform() < de_cr)
+                trials(i, k) = population(i, a) + de_f * (population(i, b) - population(i, c));
+            else
+                trials(i, k) = population(i, k);
+        }
+    }
+    project(trials);
+
+    Eigen::VectorXd trial_fitness;
+    evaluate_points(trials, trial_fitness);
+    update_best(trials, trial_fitness);
+
+    for (int k = 0; k < population_size; ++k) {
+        if (trial_fitness(k) <= fitness(k)) {
+            population.col(k) = trials.col(k);
+            fitness(k) = trial_fitness(k);
+        }
+    }
+}
+
+void Population_search::optimization() {
+    if (!is_resumed) {
+        num_of_iter = 0;
+        num_of_iter_since_last_approx = 0;
+    }
+    is_resumed = false;
+
+    int dim = function->get_dim();
+    if (strategy == DIFFERENTIAL_EVOLUTION && population.cols() != population_size) {
+        population.resize(dim, population_size);
+        population.col(0) = Eigen::Map<const Eigen::VectorXd>(seq_x_i.back().data(), dim);
+        for (int k = 1; k < population_size; ++k) {
+            for (int i = 0; i < dim; ++i) {
+                population(i, k) = box[i].first + generator.uniform() * (box[i].second - box[i].first);
+            }
+        }
+        evaluate_points(population, fitness);
+        update_best(population, fitness);
+    }
+
+    while (!is_finished()) {
+        ++num_of_iter;
+        ++num_of_iter_since_last_approx;
+
+        if (strategy == CMA_ES)
+            cma_generation();
+        else
+            de_generation();
+
+        checkpoint_if_due();
+    }
+
+    checkpoint_on_finish();
+}
+
+void Population_search::save_state(std::ostream& out) {
+    Optimization_method::save_state(out);
+
+    Checkpoint::write_value<int32_t>(out, strategy);
+    Checkpoint::write_value<int32_t>(out, population_size);
+    Checkpoint::write_value<uint32_t>(out, seed);
+    generator.save_state(out);
+    Checkpoint::write_value<uint8_t>(out, has_spare_normal);
+    Checkpoint::write_value<double>(out, spare_normal);
+    Checkpoint::write_value<double>(out, sigma);
+    Checkpoint::write_value<double>(out, de_f);
+    Checkpoint::write_value<double>(out, de_cr);
+    write_matrix(out, population);
+    write_matrix(out, fitness);
+    if (strategy == CMA_ES) {
+        write_matrix(out, mean);
+        write_matrix(out, C);
+        write_matrix(out, B);
+        write_matrix(out, D);
+        write_matrix(out, pc);
+        write_matrix(out, ps);
+        Checkpoint::write_value<int32_t>(out, eigen_iter);
+    }
+}
+
+void Population_search::load_state(std::istream& in) {
+    Optimization_method::load_state(in);
+
+    if (Checkpoint::read_value<int32_t>(in) != strategy || Checkpoint::read_value<int32_t>(in) != population_size)
+        throw std::runtime_error("Checkpoint does not match the population search configuration.");
+    seed = Checkpoint::read_value<uint32_t>(in);
+    generator.load_state(in);
+    has_spare_normal = Checkpoint::read_value<uint8_t>(in) != 0;
+    spare_normal = Checkpoint::read_value<double>(in);
+    sigma = Checkpoint::read_value<double>(in);
+    de_f = Checkpoint::read_value<double>(in);
+    de_cr = Checkpoint::read_value<double>(in);
+    read_matrix(in, population);
+    read_matrix(in, fitness);
+    if (strategy == CMA_ES) {
+        read_matrix(in, mean);
+        read_matrix(in, C);
+        read_matrix(in, B);
+        read_matrix(in, D);
+        read_matrix(in, pc);
+        read_matrix(in, ps);
+        // The decomposition of C is refreshed only every few iterations, so it is restored as it was.
+        eigen_iter = Checkpoint::read_value<int32_t>(in);
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Stop_criterion.h"
+#include "Optimization_method.h"
+#include "Sampler.h"
+#include "Thread_pool.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <Eigen/Dense>
+
+/**
+ * @brief Strategy of the population-based search.
+ */
+enum Population_strategy {
+    CMA_ES = 1, /**< Covariance matrix adaptation evolution strategy. */
+    DIFFERENTIAL_EVOLUTION = 2 /**< Differential evolution DE/rand/1/bin. */
+};
+
+/**
+ * @brief Population-based optimization method class: CMA-ES or differential evolution.
+ *
+ * One iteration is one generation. The individuals of a generation are evaluated in parallel on
+ * copies of the objective function (see Function::clone); if the function cannot be copied, they are
+ * evaluated one after another. The population is stored as a dim x population_size matrix, one column
+ * per individual. Points leaving the area are projected onto its box.
+ */
+class Population_search : public Optimization_method {
+private:
+    Population_strategy strategy; /**< Strategy of the search. */
+    int population_size; /**< Number of individuals in a generation. */
+    unsigned seed; /**< Seed for random number generation. */
+    Xoshiro256 generator; /**< Random number generator. */
+    bool has_spare_normal; /**< True if spare_normal holds an unused normal number. */
+    double spare_normal; /**< Second number generated by the Box-Muller transform. */
+    std::vector<std::pair<double, double>> box; /**< Bounding box of the area. */
+    std::unique_ptr<Thread_pool> pool; /**< Threads evaluating the generations. */
+    std::vector<Function*> clones; /**< Copy of the function for every thread, empty if the function cannot be copied. */
+
+    Eigen::MatrixXd population; /**< Current individuals, one column per individual. */
+    Eigen::VectorXd fitness; /**< Function values of the individuals. */
+
+    Eigen::VectorXd mean; /**< CMA-ES: mean of the search distribution. */
+    double sigma; /**< CMA-ES: step size. */
+    Eigen::MatrixXd C; /**< CMA-ES: covariance matrix. */
+    Eigen::MatrixXd B; /**< CMA-ES: eigenvectors of C. */
+    Eigen::VectorXd D; /**< CMA-ES: square roots of the eigenvalues of C. */
+    Eigen::VectorXd pc; /**< CMA-ES: evolution path of C. */
+    Eigen::VectorXd ps; /**< CMA-ES: evolution path of sigma. */
+    Eigen::VectorXd weights; /**< CMA-ES: recombination weights of the mu best individuals. */
+    int mu; /**< CMA-ES: number of individuals used for recombination. */
+    double mueff; /**< CMA-ES: variance effective selection mass. */
+    double cc; /**< CMA-ES: learning rate of pc. */
+    double cs; /**< CMA-ES: learning rate of ps. */
+    double c1; /**< CMA-ES: learning rate of the rank-one update. */
+    double cmu; /**< CMA-ES: learning rate of the rank-mu update. */
+    double damps; /**< CMA-ES: damping of the step size. */
+    double chi_n; /**< CMA-ES: expected norm of a standard normal vector. */
+    int eigen_iter; /**< CMA-ES: iteration of the last eigendecomposition of C. */
+
+    double de_f; /**< Differential evolution: differential weight. */
+    double de_cr; /**< Differential evolution: crossover probability. */
+
+    /**
+     * @brief Generates a standard normal number.
+     * @return Standard normal number.
+     */
+    double normal();
+
+    /**
+     * @brief Projects the columns of a matrix onto the box of the area.
+     * @param points Points, one column per point.
+     */
+    void project(Eigen::MatrixXd& points);
+
+    /**
+     * @brief Evaluates the function at the columns of a matrix, in parallel if possible.
+     * @param points Points, one column per point.
+     * @param values Receives the function values.
+     */
+    void evaluate_points(const Eigen::MatrixXd& points, Eigen::VectorXd& values);
+
+    /**
+     * @brief Records the points of a generation and appends the best one to the iterates if it improves them.
+     * @param points Points of the generation.
+     * @param values Function values of the points.
+     */
+    void update_best(const Eigen::MatrixXd& points, const Eigen::VectorXd& values);
+
+    /**
+     * @brief Performs one generation of CMA-ES.
+     */
+    void cma_generation();
+
+    /**
+     * @brief Performs one generation of differential evolution.
+     */
+    void de_generation();
+
+protected:
+    /**
+     * @brief Serializes the state of the search, including the population and the random number generator.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
+
+public:
+    /**
+     * @brief Constructor for the population-based search.
+     * @param function Pointer to the objective function.
+     * @param x_0 Initial point for optimization, the first mean or individual.
+     * @param area Area constraint for optimization.
+     * @param stop_criterion Pointer to the stopping criterion.
+     * @param strategy_ Strategy of the search.
+     * @param population_size_ Number of individuals, 0 for the default of the strategy; at least 4 are used.
+     * @param sigma_ Initial CMA-ES step size, 0 for 0.3 of the mean width of the box.
+     * @param num_of_threads Number of threads evaluating the generations, 0 for the number of hardware threads.
+     */
+    Population_search(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+        Population_strategy strategy_ = CMA_ES, int population_size_ = 0, double sigma_ = 0, int num_of_threads = 0);
+
+    /**
+     * @brief Destructor. Deletes the copies of the function.
+     */
+    ~Population_search();
+
+    /**
+     * @brief Sets the parameters of differential evolution.
+     * @param de_f_ Differential weight, usually in (0.4; 1).
+     * @param de_cr_ Crossover probability in [0; 1].
+     */
+    void set_de_parameters(double de_f_, double de_cr_);
+
+    /**
+     * @brief Getter for the current population.
+     * @return Matrix with one column per individual.
+     */
+    const Eigen::MatrixXd& get_population();
+
+    /**
+     * @brief Perform the population-based optimization.
+     */
+    void optimization() override;
+};
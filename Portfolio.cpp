@@ -0,0 +1,55 @@
+#include "Portfolio.h"
+
+Portfolio::Portfolio(double target_f_, double time_limit_, bool is_sharing_)
+    : target_f(target_f_), time_limit(time_limit_), is_sharing(is_sharing_) {}
+
+Portfolio::~Portfolio() {
+    for (Optimization_method* method : methods) {
+        delete method;
+    }
+}
+
+void Portfolio::add(Optimization_method* method, const std::string& name) {
+    methods.push_back(method);
+    names.push_back(name);
+}
+
+Optimization_method* Portfolio::get_method(int i) {
+    return methods.at(i);
+}
+
+Portfolio_result Portfolio::run() {
+    Incumbent incumbent;
+    for (int i = 0; i < static_cast<int>(methods.size()); ++i) {
+        incumbent.update(methods[i]->get_x(), methods[i]->get_f(), -1);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<Optimization_task>> tasks;
+    for (int i = 0; i < static_cast<int>(methods.size()); ++i) {
+        std::shared_ptr<Run_control> control = std::make_shared<Run_control>();
+        control->set_target_f(target_f);
+        control->set_time_limit(time_limit);
+        control->set_incumbent(&incumbent, i, is_sharing);
+        tasks.emplace_back(new Optimization_task(methods[i], control));
+    }
+
+    Portfolio_result result;
+    for (int i = 0; i < static_cast<int>(tasks.size()); ++i) {
+        result.stop_reasons.push_back(tasks[i]->get());
+    }
+    tasks.clear();
+
+    // A method that stopped by its own criterion does not check the incumbent again.
+    for (int i = 0; i < static_cast<int>(methods.size()); ++i) {
+        incumbent.update(methods[i]->get_x(), methods[i]->get_f(), i);
+    }
+
+    result.winner = incumbent.get_owner();
+    result.name = result.winner >= 0 ? names[result.winner] : "";
+    result.f = incumbent.get_f();
+    result.x = incumbent.get_x();
+    result.is_target_reached = result.f <= target_f;
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
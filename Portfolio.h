@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Optimization_method.h"
+#include "Run_control.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+
+/**
+ * @brief Result of a portfolio run.
+ */
+struct Portfolio_result {
+    int winner; /**< Index of the configuration that found the best point, -1 if none improved the start. */
+    std::string name; /**< Name of the winning configuration. */
+    double f; /**< Best function value. */
+    std::vector<double> x; /**< Best point. */
+    bool is_target_reached; /**< True if the target function value was reached. */
+    double elapsed_seconds; /**< Wall-clock time of the run. */
+    std::vector<Stop_reason> stop_reasons; /**< Reason why each configuration has stopped. */
+};
+
+/**
+ * @brief Class racing several configured optimization methods on the same problem.
+ *
+ * Every method runs in its own thread. The methods publish their improvements to a shared
+ * incumbent and, if sharing is enabled, continue from it when another method is ahead.
+ * As soon as the incumbent reaches the target value all methods stop.
+ * Each method must have its own Function and Stop_criterion objects.
+ */
+class Portfolio {
+private:
+    std::vector<Optimization_method*> methods; /**< Configured methods, owned by the portfolio. */
+    std::vector<std::string> names; /**< Names of the configurations. */
+    double target_f; /**< Target function value. */
+    double time_limit; /**< Time limit in seconds, 0 if there is no limit. */
+    bool is_sharing; /**< True if the methods continue from the shared incumbent. */
+
+public:
+    /**
+     * @brief Constructor for the portfolio.
+     * @param target_f_ Target function value.
+     * @param time_limit_ Time limit in seconds, 0 if there is no limit.
+     * @param is_sharing_ If true, the methods continue from the best point found by any of them.
+     */
+    Portfolio(double target_f_, double time_limit_ = 0, bool is_sharing_ = true);
+
+    /**
+     * @brief Destructor. Deletes the methods.
+     */
+    ~Portfolio();
+
+    Portfolio(const Portfolio&) = delete;
+    Portfolio& operator=(const Portfolio&) = delete;
+
+    /**
+     * @brief Adds a configured method to the portfolio.
+     * @param method Pointer to the optimization method, owned by the portfolio afterwards.
+     * @param name Name of the configuration used in the result.
+     */
+    void add(Optimization_method* method, const std::string& name);
+
+    /**
+     * @brief Getter for a configured method.
+     * @param i Index of the configuration.
+     * @return Pointer to the optimization method.
+     */
+    Optimization_method* get_method(int i);
+
+    /**
+     * @brief Runs all methods concurrently until one reaches the target or all have stopped.
+     * @return Result of the race.
+     */
+    Portfolio_result run();
+};
@@ -0,0 +1,285 @@
+#include "Process_runner.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#ifndef _WIN32
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    /**
+     * @brief Beginning of the shared memory of a run.
+     */
+    struct Shared_header {
+        std::atomic<int> next_shard; /**< Index of the next shard to be taken from the queue. */
+        std::atomic<int> best_shard; /**< Index of the shard holding the incumbent, -1 if there is none. */
+    };
+
+    /**
+     * @brief Result slot of a shard in the shared memory, followed by dim coordinates of the point.
+     * Only the worker that took the shard writes the slot; the incumbent refers to slots whose status is SHARD_DONE,
+     * which are never written again.
+     */
+    struct Shard_slot {
+        std::atomic<int> status; /**< Shard_status of the shard. */
+        int pid; /**< Process that took the shard. */
+        int num_of_iter; /**< Number of iterations of the method. */
+        double f; /**< Best function value. */
+        long long num_of_evaluations; /**< Number of function evaluations. */
+    };
+
+    const size_t cache_line = 64;
+
+    size_t align_up(size_t n) {
+        return (n + cache_line - 1) / cache_line * cache_line;
+    }
+
+    struct Shared_layout {
+        char* base;
+        size_t slot_size;
+
+        Shared_header* header() const {
+            return reinterpret_cast<Shared_header*>(base);
+        }
+
+        Shard_slot* slot(int k) const {
+            return reinterpret_cast<Shard_slot*>(base + align_up(sizeof(Shared_header)) + k * slot_size);
+        }
+
+        double* x(int k) const {
+            return reinterpret_cast<double*>(reinterpret_cast<char*>(slot(k)) + sizeof(Shard_slot));
+        }
+    };
+
+    void publish(const Shared_layout& shared, int k) {
+        double f = shared.slot(k)->f;
+        if (std::isnan(f))
+            return;
+
+        int best = shared.header()->best_shard.load(std::memory_order_acquire);
+        while (best < 0 || f < shared.slot(best)->f) {
+            if (shared.header()->best_shard.compare_exchange_weak(best, k, std::memory_order_acq_rel))
+                break;
+        }
+    }
+}
+
+Process_runner::Process_runner(int num_of_workers_, int dim_)
+    : num_of_workers(num_of_workers_), dim(dim_), is_pinned(false), target_f(-std::numeric_limits<double>::infinity()) {
+    if (dim <= 0)
+        throw std::invalid_argument("Dimension must be positive.");
+    if (num_of_workers <= 0)
+        num_of_workers = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Process_runner::set_pinning(bool is_pinned_) {
+    is_pinned = is_pinned_;
+}
+
+void Process_runner::set_target_f(double target_f_) {
+    target_f = target_f_;
+}
+
+void Process_runner::add_shard(const std::vector<double>& x_0) {
+    if (static_cast<int>(x_0.size()) != dim)
+        throw std::invalid_argument("Start point dimension does not match the runner.");
+    starts.push_back(x_0);
+}
+
+int Process_runner::get_num_of_shards() {
+    return static_cast<int>(starts.size());
+}
+
+#ifdef _WIN32
+
+void Process_runner::work(void* shared, const Method_factory& factory) {}
+
+Process_result Process_runner::run(const Method_factory& factory) {
+    throw std::runtime_error("Process runner requires a POSIX system.");
+}
+
+#else
+
+void Process_runner::work(void* shared_memory, const Method_factory& factory) {
+    Shared_layout shared = { static_cast<char*>(shared_memory), align_up(sizeof(Shard_slot) + dim * sizeof(double)) };
+    int num_of_shards = static_cast<int>(starts.size());
+
+    while (true) {
+        int k = shared.header()->next_shard.fetch_add(1);
+        if (k >= num_of_shards)
+            break;
+
+        Shard_slot* slot = shared.slot(k);
+        int best = shared.header()->best_shard.load(std::memory_order_acquire);
+        if (best >= 0 && shared.slot(best)->f <= target_f) {
+            slot->status.store(SHARD_SKIPPED, std::memory_order_release);
+            continue;
+        }
+
+        slot->pid = getpid();
+        slot->status.store(SHARD_RUNNING, std::memory_order_release);
+        try {
+            std::unique_ptr<Optimization_method> method(factory(starts[k], k));
+            method->optimization();
+
+            const std::vector<double>& x = method->get_x();
+            std::copy(x.begin(), x.end(), shared.x(k));
+            slot->f = method->get_f();
+            slot->num_of_iter = method->get_num_of_iter();
+            slot->num_of_evaluations = method->get_function()->get_num_of_evaluations();
+            slot->status.store(SHARD_DONE, std::memory_order_release);
+            publish(shared, k);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Shard " << k << ": " << e.what() << std::endl;
+            slot->status.store(SHARD_FAILED, std::memory_order_release);
+        }
+        catch (...) {
+            std::cerr << "Shard " << k << ": unknown exception" << std::endl;
+            slot->status.store(SHARD_FAILED, std::memory_order_release);
+        }
+    }
+}
+
+Process_result Process_runner::run(const Method_factory& factory) {
+    int num_of_shards = static_cast<int>(starts.size());
+    size_t slot_size = align_up(sizeof(Shard_slot) + dim * sizeof(double));
+    size_t size = align_up(sizeof(Shared_header)) + std::max(num_of_shards, 1) * slot_size;
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        throw std::runtime_error("Cannot allocate shared memory for the workers.");
+    Shared_layout shared = { static_cast<char*>(memory), slot_size };
+    new (shared.header()) Shared_header();
+    shared.header()->next_shard.store(0);
+    shared.header()->best_shard.store(-1);
+    for (int k = 0; k < num_of_shards; ++k) {
+        new (shared.slot(k)) Shard_slot();
+        shared.slot(k)->status.store(SHARD_PENDING);
+        shared.slot(k)->f = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::cout.flush();
+    std::cerr.flush();
+
+    // Forks a worker with the given index; returns its pid or -1.
+    auto spawn = [&](int worker) {
+        pid_t pid = fork();
+        if (pid == 0) {
+#ifdef __linux__
+            if (is_pinned) {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(worker % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+                sched_setaffinity(0, sizeof(cpus), &cpus);
+            }
+#endif
+            // The child must never return past fork(), or it would go on running the parent's loop.
+            try {
+                work(memory, factory);
+                std::cout.flush();
+                std::cerr.flush();
+            }
+            catch (...) {
+                _exit(1);
+            }
+            _exit(0);
+        }
+        return static_cast<int>(pid);
+    };
+
+    std::vector<int> workers; // pid of every worker slot, -1 if the slot is free
+    for (int w = 0; w < std::min(num_of_workers, num_of_shards); ++w) {
+        workers.push_back(spawn(w));
+    }
+
+    Process_result result;
+    result.num_of_crashes = 0;
+    int num_of_running = 0;
+    for (int pid : workers) {
+        num_of_running += pid > 0;
+    }
+    if (num_of_running == 0 && num_of_shards > 0) {
+        munmap(memory, size);
+        throw std::runtime_error("Cannot start worker processes.");
+    }
+
+    // Only the workers are waited for: other children of the process belong to the caller.
+    while (num_of_running > 0) {
+        bool is_reaped = false;
+        for (int w = 0; w < static_cast<int>(workers.size()); ++w) {
+            int pid = workers[w];
+            if (pid <= 0)
+                continue;
+            int status = 0;
+            pid_t waited = waitpid(pid, &status, WNOHANG);
+            if (waited == 0 || (waited < 0 && errno == EINTR))
+                continue;
+            is_reaped = true;
+            workers[w] = -1;
+            --num_of_running;
+
+            // A worker reaped elsewhere (ECHILD) has an unknown status and is handled like a crashed one.
+            if (waited > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+                continue;
+
+            // The worker died: its current shard is lost, the rest of the queue goes to a replacement.
+            ++result.num_of_crashes;
+            for (int k = 0; k < num_of_shards; ++k) {
+                Shard_slot* slot = shared.slot(k);
+                if (slot->status.load(std::memory_order_acquire) == SHARD_RUNNING && slot->pid == pid)
+                    slot->status.store(SHARD_FAILED, std::memory_order_release);
+            }
+            if (shared.header()->next_shard.load() < num_of_shards) {
+                workers[w] = spawn(w);
+                num_of_running += workers[w] > 0;
+            }
+        }
+        if (!is_reaped)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // A worker that died between taking a shard and marking it running leaves the shard pending.
+    int num_of_taken = std::min(shared.header()->next_shard.load(), num_of_shards);
+    for (int k = 0; k < num_of_taken; ++k) {
+        if (shared.slot(k)->status.load(std::memory_order_acquire) == SHARD_PENDING)
+            shared.slot(k)->status.store(SHARD_FAILED, std::memory_order_release);
+    }
+
+    result.best_shard = shared.header()->best_shard.load(std::memory_order_acquire);
+    result.f = result.best_shard >= 0 ? shared.slot(result.best_shard)->f : std::numeric_limits<double>::infinity();
+    if (result.best_shard >= 0)
+        result.x.assign(shared.x(result.best_shard), shared.x(result.best_shard) + dim);
+    for (int k = 0; k < num_of_shards; ++k) {
+        Shard_slot* slot = shared.slot(k);
+        Shard_result shard;
+        shard.status = static_cast<Shard_status>(slot->status.load(std::memory_order_acquire));
+        shard.f = slot->f;
+        shard.num_of_iter = 0;
+        shard.num_of_evaluations = 0;
+        if (shard.status == SHARD_DONE) {
+            shard.x.assign(shared.x(k), shared.x(k) + dim);
+            shard.num_of_iter = slot->num_of_iter;
+            shard.num_of_evaluations = slot->num_of_evaluations;
+        }
+        result.shards.push_back(shard);
+    }
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    munmap(memory, size);
+    return result;
+}
+
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Optimization_method.h"
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief State of a shard of a multi-process run.
+ */
+enum Shard_status {
+    SHARD_PENDING = 0, /**< The shard has not been taken by a worker. */
+    SHARD_RUNNING = 1, /**< A worker is optimizing the shard, or died while doing so. */
+    SHARD_DONE = 2, /**< The shard was optimized. */
+    SHARD_FAILED = 3, /**< The optimization threw an exception or the worker process died. */
+    SHARD_SKIPPED = 4 /**< The shard was not started because the target value had been reached. */
+};
+
+/**
+ * @brief Result of one shard of a multi-process run.
+ */
+struct Shard_result {
+    Shard_status status; /**< State of the shard at the end of the run. */
+    double f; /**< Best function value found from the shard. */
+    std::vector<double> x; /**< Best point found from the shard. */
+    int num_of_iter; /**< Number of iterations of the method. */
+    long long num_of_evaluations; /**< Number of function evaluations of the method. */
+};
+
+/**
+ * @brief Result of a multi-process run.
+ */
+struct Process_result {
+    int best_shard; /**< Index of the shard with the best point, -1 if no shard was optimized. */
+    double f; /**< Best function value. */
+    std::vector<double> x; /**< Best point. */
+    int num_of_crashes; /**< Number of worker processes that died abnormally. */
+    double elapsed_seconds; /**< Wall-clock time of the run. */
+    std::vector<Shard_result> shards; /**< Results of the shards in the order they were added. */
+};
+
+/**
+ * @brief Class running shards of work (start points or problems) in separate worker processes.
+ *
+ * The workers are forked from the calling process and build their own optimization methods with a
+ * factory, so each process has its own memory and may be pinned to its own CPU. They take shards from
+ * a work queue in shared memory and publish every result into a shared incumbent slot updated with a
+ * compare-and-swap, without locks. A worker dying in an objective loses only its current shard: the
+ * shard is marked as failed and a new worker replaces the dead one.
+ * Supported on POSIX systems only.
+ */
+class Process_runner {
+public:
+    /**
+     * @brief Function building the optimization method for a shard inside a worker process.
+     * Receives the start point and the index of the shard; the returned method is deleted by the worker.
+     */
+    typedef std::function<Optimization_method*(const std::vector<double>& x_0, int shard)> Method_factory;
+
+private:
+    int num_of_workers; /**< Number of worker processes. */
+    int dim; /**< Dimension of the points. */
+    bool is_pinned; /**< True if worker k is pinned to CPU k modulo the number of CPUs. */
+    double target_f; /**< Function value at which no new shards are started, -infinity if there is no target. */
+    std::vector<std::vector<double>> starts; /**< Start point of every shard. */
+
+    /**
+     * @brief Main loop of a worker process: takes shards from the queue until it is empty.
+     * @param shared Shared memory of the run.
+     * @param factory Function building the methods.
+     */
+    void work(void* shared, const Method_factory& factory);
+
+public:
+    /**
+     * @brief Constructor for the runner.
+     * @param num_of_workers_ Number of worker processes, 0 for the number of hardware threads.
+     * @param dim_ Dimension of the points.
+     */
+    Process_runner(int num_of_workers_, int dim_);
+
+    /**
+     * @brief Enables pinning of the workers to CPUs, which keeps the memory of a worker on its NUMA node.
+     * @param is_pinned_ If true, worker k runs on CPU k modulo the number of CPUs.
+     */
+    void set_pinning(bool is_pinned_);
+
+    /**
+     * @brief Sets the target function value. Once the incumbent reaches it, the remaining shards are skipped.
+     * @param target_f_ Target function value.
+     */
+    void set_target_f(double target_f_);
+
+    /**
+     * @brief Adds a shard to the work queue.
+     * @param x_0 Start point of the shard.
+     */
+    void add_shard(const std::vector<double>& x_0);
+
+    /**
+     * @brief Getter for the number of shards.
+     * @return Number of shards.
+     */
+    int get_num_of_shards();
+
+    /**
+     * @brief Forks the workers, waits for all shards to be processed and gathers the results.
+     * @param factory Function building the method for a shard inside a worker.
+     * @return Result of the run.
+     */
+    Process_result run(const Method_factory& factory);
+};
@@ -1,47 +1,103 @@
 #include "Random_search.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
 
-Random_search::Random_search() {}
+Random_search::Random_search() : global_sampler(nullptr), is_fast_generator(false) {}
 
 Random_search::Random_search(Function* function, std::vector<double> x_0, Area area,
     Stop_criterion* stop_criterion, double p_, double delta_, double alpha_)
     : Optimization_method(function, x_0, area, stop_criterion), p(p_), delta(delta_), curr_delta(delta_), alpha(alpha_),
-    seed(static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count())), generator(seed), distribution(0, 1) {
+    seed(static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count())), generator(seed), distribution(0, 1),
+    global_sampler(nullptr), is_fast_generator(false), fast_generator(seed) {
   
 }
 
+Random_search::~Random_search() {
+    delete global_sampler;
+}
+
+void Random_search::set_global_sampler(Sampler* global_sampler_) {
+    if (global_sampler_ != nullptr && global_sampler_->get_dim() != function->get_dim())
+        throw std::invalid_argument("Sampler dimension does not match the function.");
+
+    delete global_sampler;
+    global_sampler = global_sampler_;
+}
+
+void Random_search::set_fast_generator(bool is_fast_generator_) {
+    is_fast_generator = is_fast_generator_;
+}
+
 void Random_search::optimization() {
-    num_of_iter = 0;
-    num_of_iter_since_last_approx = 0;
+    if (!is_resumed) {
+        num_of_iter = 0;
+        num_of_iter_since_last_approx = 0;
+    }
+    is_resumed = false;
 
     int dim = function->get_dim();
     std::vector<std::pair<double, double>> box = area.get_box();
     bool is_in_small_area = false;
     double min = 0, max = 0; 
+    std::vector<double> new_x(dim), u(dim);
+    std::vector<float> single_x(dim);
+    is_single_phase = is_mixed_precision;
+    is_single_exhausted = false;
+    if (is_single_phase)
+        seq_f_i.back() = function->evaluate_single(std::vector<float>(seq_x_i.back().begin(), seq_x_i.back().end()));
 
-    while (!stop_criterion->termination(this)) {
+    while (!is_finished()) {
+        // A gradient criterion has found the single precision derivatives below their resolution.
+        if (is_single_exhausted)
+            leave_single_precision();
         ++num_of_iter;
         ++num_of_iter_since_last_approx;
-        std::vector<double> new_x;
 
-        if (1 - p > distribution(generator)) { //      D.
-            for (int i = 0; i < dim; ++i) {
-                min = box[i].first;
-                max = box[i].second;
-                new_x.push_back(min + distribution(generator) * (max - min));
+        {
+            TRACE_SCOPE("sample");
+            if (1 - p > (is_fast_generator ? fast_generator.uniform() : distribution(generator))) { //      D.
+                if (global_sampler)
+                    global_sampler->next(u.data());
+                else
+                    draw_uniform(u);
+
+                for (int i = 0; i < dim; ++i) {
+                    min = box[i].first;
+                    max = box[i].second;
+                    new_x[i] = min + u[i] * (max - min);
+                }
+                is_in_small_area = false;
             }
-            is_in_small_area = false;
-        }
-        else { //    D  B(x_n, delta)
-            for (int i = 0; i < dim; ++i) {
-                min = seq_x_i.back()[i] - curr_delta > box[i].first ? seq_x_i.back()[i] - curr_delta : box[i].first;
-                max = seq_x_i.back()[i] + curr_delta < box[i].second ? seq_x_i.back()[i] + curr_delta : box[i].second;
-                new_x.push_back(min + distribution(generator) * (max - min));
+            else { //    D  B(x_n, delta)
+                draw_uniform(u);
+                const std::vector<double>& x_n = seq_x_i.back();
+                for (int i = 0; i < dim; ++i) {
+                    min = x_n[i] - curr_delta > box[i].first ? x_n[i] - curr_delta : box[i].first;
+                    max = x_n[i] + curr_delta < box[i].second ? x_n[i] + curr_delta : box[i].second;
+                    new_x[i] = min + u[i] * (max - min);
+                }
+                is_in_small_area = true;
             }
-            is_in_small_area = true;
         }
 
-        double new_f;
-        if ((new_f = function->calculate(new_x)) < seq_f_i.back()) {
+        TRACE_SCOPE("evaluate");
+        double new_f = 0;
+        if (is_single_phase) {
+            std::copy(new_x.begin(), new_x.end(), single_x.begin());
+            new_f = function->evaluate_single(single_x);
+            // Single precision cannot rank points whose values differ by less than its resolution.
+            double resolution = std::max(stop_criterion->get_eps(), 16 * FLT_EPSILON * std::max(std::fabs(seq_f_i.back()), 1.0));
+            if (std::fabs(new_f - seq_f_i.back()) <= resolution) {
+                leave_single_precision();
+                new_f = function->evaluate(new_x);
+            }
+        }
+        else {
+            new_f = function->evaluate(new_x);
+        }
+        bool is_accepted = new_f < seq_f_i.back();
+        if (is_accepted) {
 
             if (is_in_small_area) {
                 curr_delta *= alpha;
@@ -54,5 +110,63 @@ void Random_search::optimization() {
             seq_x_i.push_back(new_x);
             num_of_iter_since_last_approx = 0;
         }
+
+        record_point(new_x, new_f, num_of_iter, is_accepted);
+        checkpoint_if_due();
     }
+
+    leave_single_precision();
+    checkpoint_on_finish();
+}
+
+void Random_search::draw_uniform(std::vector<double>& u) {
+    if (is_fast_generator) {
+        fast_generator.fill(u.data(), static_cast<int>(u.size()));
+        return;
+    }
+    for (int i = 0; i < static_cast<int>(u.size()); ++i) {
+        u[i] = distribution(generator);
+    }
+}
+
+void Random_search::save_state(std::ostream& out) {
+    Optimization_method::save_state(out);
+
+    Checkpoint::write_value<double>(out, p);
+    Checkpoint::write_value<double>(out, delta);
+    Checkpoint::write_value<double>(out, curr_delta);
+    Checkpoint::write_value<double>(out, alpha);
+    Checkpoint::write_value<uint32_t>(out, seed);
+
+    std::ostringstream engine_state;
+    engine_state << generator << ' ' << distribution;
+    Checkpoint::write_string(out, engine_state.str());
+
+    Checkpoint::write_value<uint8_t>(out, is_fast_generator);
+    fast_generator.save_state(out);
+    Checkpoint::write_value<uint8_t>(out, global_sampler != nullptr);
+    if (global_sampler)
+        global_sampler->save_state(out);
+}
+
+void Random_search::load_state(std::istream& in) {
+    Optimization_method::load_state(in);
+
+    p = Checkpoint::read_value<double>(in);
+    delta = Checkpoint::read_value<double>(in);
+    curr_delta = Checkpoint::read_value<double>(in);
+    alpha = Checkpoint::read_value<double>(in);
+    seed = Checkpoint::read_value<uint32_t>(in);
+
+    std::istringstream engine_state(Checkpoint::read_string(in));
+    if (!(engine_state >> generator >> distribution))
+        throw std::runtime_error("Checkpoint does not contain the random search state.");
+
+    is_fast_generator = Checkpoint::read_value<uint8_t>(in) != 0;
+    fast_generator.load_state(in);
+    bool has_sampler = Checkpoint::read_value<uint8_t>(in) != 0;
+    if (has_sampler != (global_sampler != nullptr))
+        throw std::runtime_error("Checkpoint global sampler does not match the random search.");
+    if (global_sampler)
+        global_sampler->load_state(in);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Area.h"
 #include "Stop_criterion.h"
 #include "Optimization_method.h"
+#include "Sampler.h"
 #include <iostream>
 #include <vector>
 #include <random>
@@ -22,6 +23,28 @@ private:
     double delta; /**< Initial radius neighborhood of a point. */
     double curr_delta; /**< Current radius neighborhood of a point. */
     double alpha; /**< Coefficient that diminishes the size of the delta neighborhood around a given point. */
+    Sampler* global_sampler; /**< Generator of points in the whole area, null if independent uniform numbers are used. */
+    bool is_fast_generator; /**< True if xoshiro256** replaces the default random engine. */
+    Xoshiro256 fast_generator; /**< Fast random number generator. */
+
+    /**
+     * @brief Fills a buffer with uniform numbers from the selected generator.
+     * @param u Buffer to be filled.
+     */
+    void draw_uniform(std::vector<double>& u);
+
+protected:
+    /**
+     * @brief Serializes the state of the random search, including the random number generator.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
 
 public:
     /**
@@ -42,6 +65,23 @@ public:
     Random_search(Function* function, std::vector<double> x_0, Area area,
         Stop_criterion* stop_criterion, double p_ = 0.5, double delta_ = 1, double alpha_ = 1);
 
+    /**
+     * @brief Destructor. Deletes the global sampler.
+     */
+    ~Random_search();
+
+    /**
+     * @brief Sets the generator of points for the global search, e.g. a low-discrepancy sequence.
+     * @param global_sampler_ Pointer to the sampler of the function dimension, owned by the method afterwards, or null.
+     */
+    void set_global_sampler(Sampler* global_sampler_);
+
+    /**
+     * @brief Switches the strategy choice and the search in B(x_n, delta) to the fast xoshiro256** generator.
+     * @param is_fast_generator_ True to use xoshiro256**, false to use the default random engine.
+     */
+    void set_fast_generator(bool is_fast_generator_);
+
     /**
      * @brief Perform the Random Search optimization.
      */
@@ -0,0 +1,203 @@
+#include "Run_control.h"
+#include "Optimization_method.h"
+
+Incumbent::Incumbent() : f(std::numeric_limits<double>::infinity()), owner(-1) {}
+
+bool Incumbent::update(const std::vector<double>& x_, double f_, int owner_) {
+    if (!(f_ < f.load()))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!(f_ < f.load()))
+        return false;
+    x = x_;
+    owner = owner_;
+    f = f_;
+    return true;
+}
+
+double Incumbent::get_f() const {
+    return f.load();
+}
+
+std::vector<double> Incumbent::get_x() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return x;
+}
+
+int Incumbent::get_owner() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return owner;
+}
+
+
+Run_control::Run_control() : is_cancelled(false), stop_reason(STOP_NOT_STOPPED), start_time(std::chrono::steady_clock::now()),
+    time_limit(0), max_num_of_evaluations(0), start_num_of_evaluations(-1), progress_interval(0.1), last_progress_time(start_time),
+    target_f(-std::numeric_limits<double>::infinity()), incumbent(nullptr), owner_id(-1), is_sharing(false) {}
+
+void Run_control::set_time_limit(double seconds) {
+    time_limit = seconds;
+}
+
+void Run_control::set_max_num_of_evaluations(long long max_num_of_evaluations_) {
+    max_num_of_evaluations = max_num_of_evaluations_;
+}
+
+void Run_control::set_progress_callback(std::function<void(const Progress&)> callback, double interval_seconds) {
+    progress_callback = callback;
+    progress_interval = interval_seconds;
+}
+
+void Run_control::set_target_f(double target_f_) {
+    target_f = target_f_;
+}
+
+void Run_control::set_incumbent(Incumbent* incumbent_, int owner_id_, bool is_sharing_) {
+    incumbent = incumbent_;
+    owner_id = owner_id_;
+    is_sharing = is_sharing_;
+}
+
+void Run_control::start() {
+    start_time = std::chrono::steady_clock::now();
+    last_progress_time = start_time;
+    start_num_of_evaluations = -1;
+    stop_reason = STOP_NOT_STOPPED;
+    is_cancelled = false;
+}
+
+void Run_control::cancel() {
+    is_cancelled = true;
+}
+
+bool Run_control::get_is_cancelled() const {
+    return is_cancelled;
+}
+
+Stop_reason Run_control::get_stop_reason() const {
+    return static_cast<Stop_reason>(stop_reason.load());
+}
+
+void Run_control::set_stop_reason(Stop_reason reason) {
+    stop_reason = reason;
+}
+
+void Run_control::report(Optimization_method* method, std::chrono::steady_clock::time_point now) {
+    Progress progress;
+    progress.num_of_iter = method->get_num_of_iter();
+    progress.num_of_iter_since_last_approx = method->get_num_of_iter_since_last_approx();
+    progress.num_of_evaluations = method->get_function()->get_num_of_evaluations() - start_num_of_evaluations;
+    progress.f = method->get_f();
+    progress.x = method->get_x();
+    progress.elapsed_seconds = std::chrono::duration<double>(now - start_time).count();
+    last_progress_time = now;
+    progress_callback(progress);
+}
+
+bool Run_control::check(Optimization_method* method) {
+    long long num_of_evaluations = method->get_function()->get_num_of_evaluations();
+    if (start_num_of_evaluations < 0)
+        start_num_of_evaluations = num_of_evaluations;
+
+    if (is_cancelled) {
+        stop_reason = STOP_CANCELLED;
+        return true;
+    }
+
+    double best_f = method->get_f();
+    if (incumbent) {
+        if (best_f < incumbent->get_f()) {
+            incumbent->update(method->get_x(), best_f, owner_id);
+        }
+        else if (is_sharing && incumbent->get_f() < best_f) {
+            std::vector<double> x = incumbent->get_x();
+            double f = incumbent->get_f();
+            method->adopt(x, f);
+        }
+        best_f = incumbent->get_f();
+    }
+
+    if (best_f <= target_f) {
+        stop_reason = STOP_TARGET;
+        return true;
+    }
+
+    if (max_num_of_evaluations > 0 && num_of_evaluations - start_num_of_evaluations >= max_num_of_evaluations) {
+        stop_reason = STOP_BUDGET;
+        return true;
+    }
+
+    // The clock is read only if something depends on it.
+    if (time_limit > 0 || progress_callback) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (progress_callback && std::chrono::duration<double>(now - last_progress_time).count() >= progress_interval)
+            report(method, now);
+
+        if (time_limit > 0 && std::chrono::duration<double>(now - start_time).count() >= time_limit) {
+            stop_reason = STOP_DEADLINE;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Run_control::is_interrupted(Optimization_method* method) {
+    if (is_cancelled) {
+        stop_reason = STOP_CANCELLED;
+        return true;
+    }
+
+    // The budget counts from the first check of the run.
+    if (max_num_of_evaluations > 0 && start_num_of_evaluations >= 0
+        && method->get_function()->get_num_of_evaluations() - start_num_of_evaluations >= max_num_of_evaluations) {
+        stop_reason = STOP_BUDGET;
+        return true;
+    }
+
+    if (time_limit > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >= time_limit) {
+        stop_reason = STOP_DEADLINE;
+        return true;
+    }
+    return false;
+}
+
+
+Optimization_task::Optimization_task(Optimization_method* method_, std::shared_ptr<Run_control> control_)
+    : method(method_), control(control_ ? control_ : std::make_shared<Run_control>()) {
+    method->set_run_control(control.get());
+    control->start();
+    result = std::async(std::launch::async, [this] {
+        method->optimization();
+        return control->get_stop_reason();
+    });
+}
+
+Optimization_task::~Optimization_task() {
+    if (result.valid()) {
+        control->cancel();
+        result.wait();
+    }
+    method->set_run_control(nullptr);
+}
+
+Run_control* Optimization_task::get_control() {
+    return control.get();
+}
+
+void Optimization_task::cancel() {
+    control->cancel();
+}
+
+bool Optimization_task::is_done() {
+    return wait_for(0);
+}
+
+bool Optimization_task::wait_for(double seconds) {
+    if (!result.valid())
+        return true;
+    return result.wait_for(std::chrono::duration<double>(seconds)) == std::future_status::ready;
+}
+
+Stop_reason Optimization_task::get() {
+    return result.get();
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <limits>
+
+class Optimization_method;
+
+/**
+ * @brief Reason why an optimization run has stopped.
+ */
+enum Stop_reason {
+    STOP_NOT_STOPPED = 0, /**< The run has not stopped yet. */
+    STOP_CRITERION = 1, /**< The stopping criterion of the method was met. */
+    STOP_CANCELLED = 2, /**< The run was cancelled. */
+    STOP_DEADLINE = 3, /**< The time limit was exceeded. */
+    STOP_BUDGET = 4, /**< The limit on the number of function evaluations was exceeded. */
+    STOP_TARGET = 5 /**< The target function value was reached by this or another run. */
+};
+
+/**
+ * @brief Snapshot of an optimization run passed to the progress callback.
+ */
+struct Progress {
+    int num_of_iter; /**< Total number of iterations. */
+    int num_of_iter_since_last_approx; /**< Number of iterations since the last approximation. */
+    long long num_of_evaluations; /**< Number of function evaluations since the start of the run. */
+    double f; /**< Current function value. */
+    std::vector<double> x; /**< Current point. */
+    double elapsed_seconds; /**< Time since the start of the run. */
+};
+
+/**
+ * @brief Best point found by several optimization runs working on the same problem.
+ *
+ * The function value can be read without locking, so runs compare against it every iteration.
+ */
+class Incumbent {
+private:
+    std::mutex mutex; /**< Mutex guarding the point and the owner. */
+    std::atomic<double> f; /**< Best function value. */
+    std::vector<double> x; /**< Best point. */
+    int owner; /**< Index of the run that found the best point, -1 if there is none. */
+
+public:
+    /**
+     * @brief Default constructor. The incumbent is empty, its value is +infinity.
+     */
+    Incumbent();
+
+    /**
+     * @brief Replaces the incumbent if the given point is better.
+     * @param x_ Point found by a run.
+     * @param f_ Function value at the point.
+     * @param owner_ Index of the run that found the point.
+     * @return True if the incumbent was replaced, false otherwise.
+     */
+    bool update(const std::vector<double>& x_, double f_, int owner_);
+
+    /**
+     * @brief Getter for the best function value.
+     * @return Best function value.
+     */
+    double get_f() const;
+
+    /**
+     * @brief Getter for the best point.
+     * @return Best point.
+     */
+    std::vector<double> get_x();
+
+    /**
+     * @brief Getter for the index of the run that found the best point.
+     * @return Index of the run, -1 if there is no incumbent.
+     */
+    int get_owner();
+};
+
+/**
+ * @brief Class controlling a running optimization: cancellation, time and evaluation limits and progress reports.
+ *
+ * The optimization method checks the control once per iteration, so a run stops at the end of
+ * the current iteration. Cancellation, the time limit and the evaluation budget are also checked
+ * between the columns of finite-difference Hessians and, in Newton_opt, between the trials of the
+ * line search. cancel() may be called from any thread.
+ */
+class Run_control {
+private:
+    std::atomic<bool> is_cancelled; /**< True if the run has been cancelled. */
+    std::atomic<int> stop_reason; /**< Reason why the run has stopped. */
+    std::chrono::steady_clock::time_point start_time; /**< Start of the run. */
+    double time_limit; /**< Time limit in seconds, 0 if there is no limit. */
+    long long max_num_of_evaluations; /**< Limit on the number of function evaluations, 0 if there is no limit. */
+    long long start_num_of_evaluations; /**< Number of evaluations of the function at the start of the run, -1 before the first check. */
+    std::function<void(const Progress&)> progress_callback; /**< Function receiving progress reports. */
+    double progress_interval; /**< Minimum time between two progress reports in seconds. */
+    std::chrono::steady_clock::time_point last_progress_time; /**< Time of the last progress report. */
+    double target_f; /**< Function value at which the run stops, -infinity if there is no target. */
+    Incumbent* incumbent; /**< Best point shared with other runs, null if the run is alone. */
+    int owner_id; /**< Index of the run when publishing to the incumbent. */
+    bool is_sharing; /**< True if the run continues from a better incumbent found by another run. */
+
+    /**
+     * @brief Reports the progress of the run to the callback.
+     * @param method Pointer to the running optimization method.
+     * @param now Current time.
+     */
+    void report(Optimization_method* method, std::chrono::steady_clock::time_point now);
+
+public:
+    /**
+     * @brief Default constructor. No limits and no progress reports.
+     */
+    Run_control();
+
+    /**
+     * @brief Sets the time limit of the run.
+     * @param seconds Time limit in seconds, 0 removes the limit.
+     */
+    void set_time_limit(double seconds);
+
+    /**
+     * @brief Sets the limit on the number of function evaluations.
+     * @param max_num_of_evaluations_ Maximum number of evaluations, 0 removes the limit.
+     */
+    void set_max_num_of_evaluations(long long max_num_of_evaluations_);
+
+    /**
+     * @brief Sets the function receiving progress reports.
+     * @param callback Function called with the current state of the run.
+     * @param interval_seconds Minimum time between two reports in seconds.
+     */
+    void set_progress_callback(std::function<void(const Progress&)> callback, double interval_seconds = 0.1);
+
+    /**
+     * @brief Sets the target function value. The run stops as soon as it or the shared incumbent reaches it.
+     * @param target_f_ Target function value.
+     */
+    void set_target_f(double target_f_);
+
+    /**
+     * @brief Connects the run to an incumbent shared with other runs.
+     * Every improvement of the run is published to the incumbent.
+     * @param incumbent_ Shared incumbent, not owned by the control.
+     * @param owner_id_ Index of the run when publishing to the incumbent.
+     * @param is_sharing_ If true, the run continues from the incumbent when another run has found a better point.
+     */
+    void set_incumbent(Incumbent* incumbent_, int owner_id_, bool is_sharing_ = true);
+
+    /**
+     * @brief Starts the clock of the run and clears the stop reason and a previous cancellation.
+     */
+    void start();
+
+    /**
+     * @brief Requests the run to stop at the end of the current iteration.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether the run has been cancelled.
+     * @return True if cancel() has been called, false otherwise.
+     */
+    bool get_is_cancelled() const;
+
+    /**
+     * @brief Getter for the reason why the run has stopped.
+     * @return Reason why the run has stopped.
+     */
+    Stop_reason get_stop_reason() const;
+
+    /**
+     * @brief Records the reason why the run has stopped.
+     * @param reason Reason why the run has stopped.
+     */
+    void set_stop_reason(Stop_reason reason);
+
+    /**
+     * @brief Checks the limits and reports the progress. Called once per iteration.
+     * @param method Pointer to the running optimization method.
+     * @return True if the run must stop, false otherwise.
+     */
+    bool check(Optimization_method* method);
+
+    /**
+     * @brief Checks cancellation, the evaluation budget and the time limit. Cheap enough to call between evaluations.
+     * @param method Pointer to the running optimization method.
+     * @return True if the run must stop, false otherwise.
+     */
+    bool is_interrupted(Optimization_method* method);
+};
+
+/**
+ * @brief Handle of an optimization running in a separate thread.
+ *
+ * Destroying the handle cancels the run and waits for it to finish.
+ */
+class Optimization_task {
+private:
+    Optimization_method* method; /**< Pointer to the running optimization method. */
+    std::shared_ptr<Run_control> control; /**< Control of the run. */
+    std::future<Stop_reason> result; /**< Result of the run. */
+
+public:
+    /**
+     * @brief Constructor starting the optimization in a separate thread.
+     * @param method_ Pointer to the optimization method, must outlive the task.
+     * @param control_ Control of the run, a new one is created if null.
+     */
+    explicit Optimization_task(Optimization_method* method_, std::shared_ptr<Run_control> control_ = nullptr);
+
+    /**
+     * @brief Destructor. Cancels the run and waits for it to finish.
+     */
+    ~Optimization_task();
+
+    Optimization_task(const Optimization_task&) = delete;
+    Optimization_task& operator=(const Optimization_task&) = delete;
+
+    /**
+     * @brief Getter for the control of the run.
+     * @return Pointer to the control of the run.
+     */
+    Run_control* get_control();
+
+    /**
+     * @brief Requests the run to stop.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether the run has finished.
+     * @return True if the run has finished, false otherwise.
+     */
+    bool is_done();
+
+    /**
+     * @brief Waits for the run to finish for at most the given time.
+     * @param seconds Maximum waiting time in seconds.
+     * @return True if the run has finished, false otherwise.
+     */
+    bool wait_for(double seconds);
+
+    /**
+     * @brief Waits for the run to finish. Rethrows an exception thrown by the optimization.
+     * @return Reason why the run has stopped.
+     */
+    Stop_reason get();
+};
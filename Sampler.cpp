@@ -0,0 +1,247 @@
+#include "Sampler.h"
+#include "Checkpoint.h"
+
+namespace {
+    uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Joe-Kuo direction numbers (new-joe-kuo-6.21201) for coordinates 2..21: degree s, coefficients a, initial m_1..m_s.
+    const struct {
+        int s;
+        uint32_t a;
+        uint32_t m[7];
+    } sobol_table[] = {
+        { 1, 0, { 1 } },
+        { 2, 1, { 1, 3 } },
+        { 3, 1, { 1, 3, 1 } },
+        { 3, 2, { 1, 1, 1 } },
+        { 4, 1, { 1, 1, 3, 3 } },
+        { 4, 4, { 1, 3, 5, 13 } },
+        { 5, 2, { 1, 1, 5, 5, 17 } },
+        { 5, 4, { 1, 1, 5, 5, 5 } },
+        { 5, 7, { 1, 1, 7, 11, 19 } },
+        { 5, 11, { 1, 1, 5, 1, 1 } },
+        { 5, 13, { 1, 1, 1, 3, 11 } },
+        { 5, 14, { 1, 3, 5, 5, 31 } },
+        { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+        { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+        { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+        { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+        { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+        { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+        { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+        { 7, 4, { 1, 3, 7, 13, 13, 15, 69 } }
+    };
+}
+
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    for (int i = 0; i < 4; ++i) {
+        s[i] = splitmix64(seed);
+    }
+}
+
+uint64_t Xoshiro256::next() {
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+double Xoshiro256::uniform() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void Xoshiro256::fill(double* u, int n) {
+    for (int i = 0; i < n; ++i) {
+        u[i] = (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+}
+
+void Xoshiro256::save_state(std::ostream& out) const {
+    for (int i = 0; i < 4; ++i) {
+        Checkpoint::write_value<uint64_t>(out, s[i]);
+    }
+}
+
+void Xoshiro256::load_state(std::istream& in) {
+    for (int i = 0; i < 4; ++i) {
+        s[i] = Checkpoint::read_value<uint64_t>(in);
+    }
+}
+
+
+Sampler::Sampler(int dim_) : dim(dim_) {}
+
+Sampler::~Sampler() {}
+
+int Sampler::get_dim() {
+    return dim;
+}
+
+void Sampler::fill(double* u, int n) {
+    for (int k = 0; k < n; ++k) {
+        next(u + k * dim);
+    }
+}
+
+
+Sampler_sobol::Sampler_sobol(int dim_, uint64_t seed_) : Sampler(dim_), index(0), seed(seed_) {
+    if (dim < 1 || dim > max_dim)
+        throw std::invalid_argument("Sobol sampler supports dimensions from 1 to 21.");
+
+    directions.assign(32 * dim, 0);
+    for (int k = 0; k < 32; ++k) {
+        directions[k] = 1u << (31 - k);
+    }
+    for (int j = 1; j < dim; ++j) {
+        uint32_t* v = &directions[32 * j];
+        int s = sobol_table[j - 1].s;
+        uint32_t a = sobol_table[j - 1].a;
+        for (int k = 0; k < s; ++k) {
+            v[k] = sobol_table[j - 1].m[k] << (31 - k);
+        }
+        for (int k = s; k < 32; ++k) {
+            v[k] = v[k - s] ^ (v[k - s] >> s);
+            for (int l = 1; l < s; ++l) {
+                if ((a >> (s - 1 - l)) & 1)
+                    v[k] ^= v[k - l];
+            }
+        }
+    }
+
+    Xoshiro256 rng(seed);
+    shift.resize(dim);
+    for (int j = 0; j < dim; ++j) {
+        shift[j] = static_cast<uint32_t>(rng.next() >> 32);
+    }
+    curr.assign(dim, 0);
+}
+
+void Sampler_sobol::next(double* u) {
+    // Gray-code order: the next point differs from the current one by the direction of the lowest zero bit of index.
+    int c = 0;
+    while ((index >> c) & 1) {
+        ++c;
+    }
+    // The direction numbers have 32 bits, which is enough for 2^32 - 1 points.
+    if (c >= 32)
+        throw std::runtime_error("Sobol sequence is exhausted after 2^32 - 1 points.");
+    ++index;
+    for (int j = 0; j < dim; ++j) {
+        curr[j] ^= directions[32 * j + c];
+        u[j] = (curr[j] ^ shift[j]) * (1.0 / 4294967296.0);
+    }
+}
+
+void Sampler_sobol::save_state(std::ostream& out) const {
+    Checkpoint::write_value<uint64_t>(out, index);
+    Checkpoint::write_value<uint64_t>(out, seed);
+}
+
+void Sampler_sobol::load_state(std::istream& in) {
+    uint64_t index_ = Checkpoint::read_value<uint64_t>(in);
+    uint64_t seed_ = Checkpoint::read_value<uint64_t>(in);
+    if (index_ > 0xFFFFFFFFull)
+        throw std::runtime_error("Checkpoint Sobol index is out of range.");
+    *this = Sampler_sobol(dim, seed_);
+
+    index = index_;
+    uint64_t gray = index ^ (index >> 1);
+    for (int c = 0; c < 32 && (gray >> c) != 0; ++c) {
+        if ((gray >> c) & 1) {
+            for (int j = 0; j < dim; ++j) {
+                curr[j] ^= directions[32 * j + c];
+            }
+        }
+    }
+}
+
+
+Sampler_halton::Sampler_halton(int dim_, uint64_t seed_) : Sampler(dim_), index(0), seed(seed_) {
+    if (dim < 1)
+        throw std::invalid_argument("Halton sampler dimension must be positive.");
+    init();
+}
+
+void Sampler_halton::init() {
+    bases.clear();
+    for (uint32_t n = 2; static_cast<int>(bases.size()) < dim; ++n) {
+        bool is_prime = true;
+        for (int k = 0; k < static_cast<int>(bases.size()) && bases[k] * bases[k] <= n; ++k) {
+            if (n % bases[k] == 0) {
+                is_prime = false;
+                break;
+            }
+        }
+        if (is_prime)
+            bases.push_back(n);
+    }
+
+    Xoshiro256 rng(seed);
+    multipliers.resize(dim);
+    for (int j = 0; j < dim; ++j) {
+        multipliers[j] = bases[j] == 2 ? 1 : 1 + static_cast<uint32_t>(rng.next() % (bases[j] - 1));
+    }
+
+    digits.assign(dim, std::vector<uint32_t>());
+    values.assign(dim, 0);
+    for (int j = 0; j < dim; ++j) {
+        uint64_t b = bases[j], n = index;
+        double scale = 1.0 / b;
+        while (n > 0) {
+            digits[j].push_back(static_cast<uint32_t>(n % b));
+            values[j] += ((multipliers[j] * (n % b)) % b) * scale;
+            scale /= b;
+            n /= b;
+        }
+    }
+}
+
+void Sampler_halton::next(double* u) {
+    ++index;
+    // Increment index in base b_i and update the radical inverse only for the digits that change.
+    for (int j = 0; j < dim; ++j) {
+        uint32_t b = bases[j];
+        uint64_t m = multipliers[j];
+        std::vector<uint32_t>& d = digits[j];
+        double scale = 1.0 / b;
+        for (int k = 0; ; ++k) {
+            if (k == static_cast<int>(d.size()))
+                d.push_back(0);
+            double old_digit = static_cast<double>((m * d[k]) % b);
+            if (++d[k] < b) {
+                values[j] += ((m * d[k]) % b - old_digit) * scale;
+                break;
+            }
+            d[k] = 0;
+            values[j] -= old_digit * scale;
+            scale /= b;
+        }
+        u[j] = values[j];
+    }
+}
+
+void Sampler_halton::save_state(std::ostream& out) const {
+    Checkpoint::write_value<uint64_t>(out, index);
+    Checkpoint::write_value<uint64_t>(out, seed);
+}
+
+void Sampler_halton::load_state(std::istream& in) {
+    index = Checkpoint::read_value<uint64_t>(in);
+    seed = Checkpoint::read_value<uint64_t>(in);
+    init();
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Fast pseudo-random number generator xoshiro256** (Blackman, Vigna).
+ */
+class Xoshiro256 {
+private:
+    uint64_t s[4]; /**< State of the generator. */
+
+public:
+    /**
+     * @brief Constructor seeding the state with splitmix64.
+     * @param seed Seed of the generator.
+     */
+    explicit Xoshiro256(uint64_t seed = 0);
+
+    /**
+     * @brief Generates the next 64-bit number.
+     * @return Pseudo-random 64-bit number.
+     */
+    uint64_t next();
+
+    /**
+     * @brief Generates a number uniformly distributed in [0, 1).
+     * @return Pseudo-random number in [0, 1).
+     */
+    double uniform();
+
+    /**
+     * @brief Fills a buffer with numbers uniformly distributed in [0, 1).
+     * @param u Buffer of at least n values.
+     * @param n Number of values.
+     */
+    void fill(double* u, int n);
+
+    /**
+     * @brief Writes the state of the generator.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) const;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in);
+};
+
+/**
+ * @brief Base class representing a generator of points in the unit cube [0, 1)^dim.
+ */
+class Sampler {
+protected:
+    int dim; /**< Dimension of the points. */
+
+public:
+    /**
+     * @brief Constructor for the sampler.
+     * @param dim_ Dimension of the points.
+     */
+    explicit Sampler(int dim_);
+
+    /**
+     * @brief Virtual destructor for proper polymorphic behavior.
+     */
+    virtual ~Sampler();
+
+    /**
+     * @brief Getter for the dimension of the points.
+     * @return Dimension of the points.
+     */
+    int get_dim();
+
+    /**
+     * @brief Pure virtual function generating the next point.
+     * @param u Buffer of dim values receiving the point.
+     */
+    virtual void next(double* u) = 0;
+
+    /**
+     * @brief Generates several consecutive points.
+     * @param u Buffer of n * dim values receiving the points one after another.
+     * @param n Number of points.
+     */
+    void fill(double* u, int n);
+
+    /**
+     * @brief Pure virtual function writing the state of the sampler.
+     * @param out Output stream.
+     */
+    virtual void save_state(std::ostream& out) const = 0;
+
+    /**
+     * @brief Pure virtual function restoring the state written by save_state.
+     * @param in Input stream.
+     */
+    virtual void load_state(std::istream& in) = 0;
+};
+
+/**
+ * @brief Sobol low-discrepancy sequence (Joe-Kuo direction numbers) scrambled by a random digital shift.
+ * Supports dimensions up to 21.
+ */
+class Sampler_sobol : public Sampler {
+private:
+    std::vector<uint32_t> directions; /**< Direction numbers, 32 per coordinate. */
+    std::vector<uint32_t> shift; /**< Random digital shift of every coordinate. */
+    std::vector<uint32_t> curr; /**< Current point as 32-bit integers before the shift. */
+    uint64_t index; /**< Number of generated points. */
+    uint64_t seed; /**< Seed of the scrambling. */
+
+public:
+    /**
+     * @brief Maximum supported dimension.
+     */
+    static const int max_dim = 21;
+
+    /**
+     * @brief Constructor for the Sobol sampler.
+     * @param dim_ Dimension of the points.
+     * @param seed_ Seed of the scrambling.
+     */
+    Sampler_sobol(int dim_, uint64_t seed_ = 0);
+
+    /**
+     * @brief Generates the next point of the sequence. The sequence has 2^32 - 1 points; asking for more throws std::runtime_error.
+     * @param u Buffer of dim values receiving the point.
+     */
+    void next(double* u) override;
+
+    /**
+     * @brief Writes the index and the seed of the sequence.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) const override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
+};
+
+/**
+ * @brief Halton low-discrepancy sequence scrambled by random digit multipliers.
+ * Digit d of coordinate i is replaced by (m_i * d) mod b_i, which keeps 0 in place and needs no tables.
+ */
+class Sampler_halton : public Sampler {
+private:
+    std::vector<uint32_t> bases; /**< Prime base of every coordinate. */
+    std::vector<uint32_t> multipliers; /**< Random digit multiplier of every coordinate, in [1, b_i - 1]. */
+    std::vector<std::vector<uint32_t>> digits; /**< Digits of index in base b_i, least significant first. */
+    std::vector<double> values; /**< Current scrambled radical inverse of every coordinate. */
+    uint64_t index; /**< Number of generated points. */
+    uint64_t seed; /**< Seed of the scrambling. */
+
+    /**
+     * @brief Builds the bases and the multipliers from the seed and the digits from the index.
+     */
+    void init();
+
+public:
+    /**
+     * @brief Constructor for the Halton sampler.
+     * @param dim_ Dimension of the points.
+     * @param seed_ Seed of the scrambling.
+     */
+    Sampler_halton(int dim_, uint64_t seed_ = 0);
+
+    /**
+     * @brief Generates the next point of the sequence.
+     * @param u Buffer of dim values receiving the point.
+     */
+    void next(double* u) override;
+
+    /**
+     * @brief Writes the index and the seed of the sequence.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) const override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
+};
@@ -31,8 +31,9 @@ bool Criterion_f_difference_min::termination(Optimization_method* optimization_m
     if (num_iter >= max_num_of_iterations)
         return true;
 
-    double curr_f = optimization_method->get_seq_f_i()[num_iter - 1],
-           prev_f = optimization_method->get_seq_f_i()[num_iter - 2];
+    std::vector<double> seq_f_i = optimization_method->get_seq_f_i();
+    double curr_f = seq_f_i[seq_f_i.size() - 1],
+           prev_f = seq_f_i[seq_f_i.size() - 2];
     return (std::abs(curr_f - prev_f )< eps);
 }
 
@@ -64,7 +65,7 @@ bool Criterion_grad_f::termination(Optimization_method* optimization_method) {
     if (optimization_method->get_num_of_iter() >= max_num_of_iterations)
         return true;
 
-    std::vector<double> grad = optimization_method->get_function()->gradient(optimization_method->get_seq_x_i().back(), eps/10, optimization_method->get_area());
+    std::vector<double> grad = optimization_method->gradient(optimization_method->get_x());
     int dim = optimization_method->get_function()->get_dim();
     double grad_sum_sq = 0;
     for (int i = 0; i < dim; ++i) {
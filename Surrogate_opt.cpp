@@ -0,0 +1,403 @@
+#include "Surrogate_opt.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    /**
+     * @brief Variance added to the diagonal of the kernel matrix, which keeps it positive definite for close points.
+     */
+    const double nugget = 1e-6;
+
+    /**
+     * @brief Number of length scales tried when the model is refitted.
+     */
+    const int num_of_length_scales = 16;
+
+    double normal_cdf(double z) {
+        return 0.5 * std::erfc(-z / std::sqrt(2.0));
+    }
+
+    double normal_pdf(double z) {
+        return std::exp(-0.5 * z * z) / std::sqrt(2 * 3.14159265358979323846);
+    }
+}
+
+Surrogate_opt::Surrogate_opt(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+    int batch_size_, int num_of_threads)
+    : Optimization_method(function, x_0, area, stop_criterion), batch_size(batch_size_),
+    seed(static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count())), generator(seed),
+    box(area.get_box()), pool(new Thread_pool(num_of_threads)), num_of_samples(0), length_scale(0.5),
+    value_mean(0), value_scale(1), num_of_fitted(0) {
+    int dim = function->get_dim();
+    if (box.size() != static_cast<size_t>(dim))
+        throw std::invalid_argument("Surrogate optimization requires a bounded area of the function dimension.");
+    for (int i = 0; i < dim; ++i) {
+        if (!std::isfinite(box[i].first) || !std::isfinite(box[i].second))
+            throw std::invalid_argument("Surrogate optimization requires a bounded area of the function dimension.");
+    }
+    if (batch_size < 1)
+        throw std::invalid_argument("Batch size must be positive.");
+
+    for (int t = 0; t < pool->get_num_of_threads(); ++t) {
+        Function* clone = function->clone();
+        if (clone == nullptr) {
+            for (Function* c : clones) {
+                delete c;
+            }
+            clones.clear();
+            break;
+        }
+        clones.push_back(clone);
+    }
+}
+
+Surrogate_opt::~Surrogate_opt() {
+    for (Function* clone : clones) {
+        delete clone;
+    }
+}
+
+void Surrogate_opt::set_seed(unsigned seed_) {
+    seed = seed_;
+    generator = Xoshiro256(seed);
+}
+
+int Surrogate_opt::get_num_of_samples() {
+    return num_of_samples;
+}
+
+double Surrogate_opt::get_length_scale() {
+    return length_scale;
+}
+
+double Surrogate_opt::kernel(const double* a, const double* b) const {
+    int dim = function->get_dim();
+    double r2 = 0;
+    for (int i = 0; i < dim; ++i) {
+        r2 += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    double r = std::sqrt(5 * r2) / length_scale;
+    return (1 + r + r * r / 3) * std::exp(-r);
+}
+
+void Surrogate_opt::append_sample(const Eigen::VectorXd& u, double value, int index) {
+    if (index >= samples.cols()) {
+        Eigen::Index capacity = std::max<Eigen::Index>(16, 2 * samples.cols());
+        samples.conservativeResize(u.size(), capacity);
+        values.conservativeResize(capacity);
+        L.conservativeResize(capacity, capacity);
+    }
+    samples.col(index) = u;
+    values(index) = value;
+
+    // The new row of the factor is l = L^-1 k with the diagonal element sqrt(k(u, u) - l^T l).
+    Eigen::VectorXd k(index);
+    for (int j = 0; j < index; ++j) {
+        k(j) = kernel(samples.col(j).data(), u.data());
+    }
+    if (index > 0)
+        L.topLeftCorner(index, index).triangularView<Eigen::Lower>().solveInPlace(k);
+    L.row(index).head(index) = k.transpose();
+    L(index, index) = std::sqrt(std::max(1 + nugget - k.squaredNorm(), nugget));
+}
+
+double Surrogate_opt::factorize(int n) {
+    Eigen::MatrixXd K(n, n);
+    for (int j = 0; j < n; ++j) {
+        for (int i = j; i < n; ++i) {
+            K(i, j) = kernel(samples.col(i).data(), samples.col(j).data());
+        }
+        K(j, j) += nugget;
+    }
+    Eigen::LLT<Eigen::MatrixXd> llt(K);
+    if (llt.info() != Eigen::Success)
+        return -std::numeric_limits<double>::infinity();
+    L.topLeftCorner(n, n) = llt.matrixL();
+    solve_weights(n);
+
+    Eigen::VectorXd y = (values.head(n).array() - value_mean) / value_scale;
+    return -0.5 * y.dot(weights) - L.topLeftCorner(n, n).diagonal().array().log().sum();
+}
+
+void Surrogate_opt::solve_weights(int n) {
+    weights = (values.head(n).array() - value_mean) / value_scale;
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(weights);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().transpose().solveInPlace(weights);
+}
+
+void Surrogate_opt::update_model() {
+    TRACE_SCOPE("surrogate fit");
+    int n = num_of_samples;
+    value_mean = values.head(n).mean();
+    value_scale = std::sqrt((values.head(n).array() - value_mean).square().mean());
+    if (!(value_scale > 0))
+        value_scale = 1;
+
+    // Every refit costs O(n^3) per length scale, so it is repeated only when the samples have grown by a tenth.
+    if (n >= num_of_fitted + std::max(1, num_of_fitted / 10)) {
+        int dim = function->get_dim();
+        double best_length_scale = length_scale, best_likelihood = -std::numeric_limits<double>::infinity();
+        for (int g = 0; g < num_of_length_scales; ++g) {
+            length_scale = std::sqrt(static_cast<double>(dim)) * std::pow(10.0, -2 + 2.5 * g / (num_of_length_scales - 1));
+            double likelihood = factorize(n);
+            if (likelihood > best_likelihood) {
+                best_likelihood = likelihood;
+                best_length_scale = length_scale;
+            }
+        }
+        length_scale = best_length_scale;
+        factorize(n);
+        num_of_fitted = n;
+    }
+    solve_weights(n);
+}
+
+double Surrogate_opt::predict(const Eigen::VectorXd& u, int n, double& sd) const {
+    Eigen::VectorXd k(n);
+    for (int j = 0; j < n; ++j) {
+        k(j) = kernel(samples.col(j).data(), u.data());
+    }
+    double mean = k.dot(weights.head(n));
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(k);
+    sd = std::sqrt(std::max(1 - k.squaredNorm(), 0.0));
+    return mean;
+}
+
+double Surrogate_opt::expected_improvement(const Eigen::VectorXd& u, int n, double best) const {
+    double sd;
+    double mean = predict(u, n, sd);
+    if (sd < 1e-12)
+        return std::max(best - mean, 0.0);
+    double z = (best - mean) / sd;
+    return (best - mean) * normal_cdf(z) + sd * normal_pdf(z);
+}
+
+Eigen::VectorXd Surrogate_opt::maximize_acquisition(int n, double best) {
+    TRACE_SCOPE("acquisition search");
+    int dim = function->get_dim();
+    int best_index;
+    values.head(num_of_samples).minCoeff(&best_index);
+
+    // Uniform candidates explore the box, normal perturbations of the best sample at scales from the
+    // length scale down to a hundredth of it exploit the region the model trusts most.
+    const int num_of_starts = 3;
+    int num_of_candidates = 400 + 100 * dim;
+    std::vector<std::pair<double, Eigen::VectorXd>> starts;
+    Eigen::VectorXd u(dim);
+    for (int c = 0; c < num_of_candidates; ++c) {
+        if (c % 2 == 0) {
+            for (int i = 0; i < dim; ++i) {
+                u(i) = generator.uniform();
+            }
+        }
+        else {
+            double scale = length_scale * std::pow(10.0, -2 * generator.uniform());
+            for (int i = 0; i < dim; ++i) {
+                double u1 = 1 - generator.uniform(), u2 = generator.uniform();
+                double z = std::sqrt(-2 * std::log(u1)) * std::cos(2 * 3.14159265358979323846 * u2);
+                u(i) = std::min(std::max(samples(i, best_index) + scale * z, 0.0), 1.0);
+            }
+        }
+        double ei = expected_improvement(u, n, best);
+        if (static_cast<int>(starts.size()) < num_of_starts || ei > starts.back().first) {
+            if (static_cast<int>(starts.size()) == num_of_starts)
+                starts.pop_back();
+            starts.emplace_back(ei, u);
+            std::sort(starts.begin(), starts.end(),
+                [](const std::pair<double, Eigen::VectorXd>& a, const std::pair<double, Eigen::VectorXd>& b) { return a.first > b.first; });
+        }
+    }
+
+    // Compass search from the best candidates, halving the step after a sweep without improvement.
+    double best_ei = 0;
+    Eigen::VectorXd result = starts.front().second;
+    for (std::pair<double, Eigen::VectorXd>& start : starts) {
+        Eigen::VectorXd x = start.second;
+        double ei = start.first;
+        double step = std::min(0.1 * length_scale, 0.25);
+        for (int sweep = 0; sweep < 20 * dim && step > 1e-6; ++sweep) {
+            bool is_improved = false;
+            for (int i = 0; i < dim; ++i) {
+                for (int sign = -1; sign <= 1; sign += 2) {
+                    Eigen::VectorXd trial = x;
+                    trial(i) = std::min(std::max(x(i) + sign * step, 0.0), 1.0);
+                    double trial_ei = expected_improvement(trial, n, best);
+                    if (trial_ei > ei) {
+                        x = trial;
+                        ei = trial_ei;
+                        is_improved = true;
+                    }
+                }
+            }
+            if (!is_improved)
+                step /= 2;
+        }
+        if (ei > best_ei) {
+            best_ei = ei;
+            result = x;
+        }
+    }
+
+    // The model expects no improvement anywhere, e.g. when it interpolates a constant: a random point adds information.
+    if (!(best_ei > 0)) {
+        for (int i = 0; i < dim; ++i) {
+            result(i) = generator.uniform();
+        }
+    }
+    return result;
+}
+
+void Surrogate_opt::evaluate_points(const Eigen::MatrixXd& points, Eigen::VectorXd& f) {
+    TRACE_SCOPE("evaluate batch");
+    int n = static_cast<int>(points.cols());
+    f.resize(n);
+
+    // The columns of the matrix are the points, stored one after another as calculate_batch() expects.
+    if (clones.empty()) {
+        function->calculate_batch(points.data(), n, f.data());
+    }
+    else {
+        pool->parallel_for(n, [&](int begin, int end, int thread) {
+            TRACE_SCOPE("evaluate part");
+            clones[thread]->calculate_batch(points.col(begin).data(), end - begin, f.data() + begin);
+        });
+    }
+    function->add_num_of_evaluations(n);
+}
+
+void Surrogate_opt::add_batch(const Eigen::MatrixXd& batch) {
+    int dim = function->get_dim();
+    Eigen::MatrixXd points(dim, batch.cols());
+    for (int k = 0; k < batch.cols(); ++k) {
+        for (int i = 0; i < dim; ++i) {
+            points(i, k) = box[i].first + batch(i, k) * (box[i].second - box[i].first);
+        }
+    }
+    Eigen::VectorXd f;
+    evaluate_points(points, f);
+
+    Eigen::Index best;
+    f.minCoeff(&best);
+    bool is_improved = f(best) < seq_f_i.back();
+
+    std::vector<double> x(dim);
+    for (int k = 0; k < batch.cols(); ++k) {
+        append_sample(batch.col(k), f(k), num_of_samples);
+        ++num_of_samples;
+        if (trajectory != nullptr) {
+            std::copy(points.col(k).data(), points.col(k).data() + dim, x.begin());
+            record_point(x, f(k), num_of_iter, is_improved && k == best);
+        }
+    }
+
+    if (is_improved) {
+        std::copy(points.col(best).data(), points.col(best).data() + dim, x.begin());
+        seq_x_i.push_back(x);
+        seq_f_i.push_back(f(best));
+        num_of_iter_since_last_approx = 0;
+    }
+}
+
+void Surrogate_opt::optimization() {
+    if (!is_resumed) {
+        num_of_iter = 0;
+        num_of_iter_since_last_approx = 0;
+    }
+    is_resumed = false;
+
+    int dim = function->get_dim();
+    if (num_of_samples == 0) {
+        Eigen::VectorXd u(dim);
+        for (int i = 0; i < dim; ++i) {
+            double width = box[i].second - box[i].first;
+            u(i) = width > 0 ? (seq_x_i.back()[i] - box[i].first) / width : 0;
+        }
+        append_sample(u, seq_f_i.back(), 0);
+        num_of_samples = 1;
+
+        // The Sobol sequence covers the box evenly; it is defined up to 21 dimensions, uniform points are used above.
+        Eigen::MatrixXd design(dim, 2 * dim);
+        std::unique_ptr<Sampler_sobol> sobol(dim <= 21 ? new Sampler_sobol(dim, seed) : nullptr);
+        for (int k = 0; k < design.cols(); ++k) {
+            if (sobol) {
+                sobol->next(design.col(k).data());
+            }
+            else {
+                for (int i = 0; i < dim; ++i) {
+                    design(i, k) = generator.uniform();
+                }
+            }
+        }
+        add_batch(design);
+        update_model();
+    }
+
+    while (!is_finished()) {
+        ++num_of_iter;
+        ++num_of_iter_since_last_approx;
+
+        int n = num_of_samples;
+        double best = (values.head(n).minCoeff() - value_mean) / value_scale;
+        Eigen::MatrixXd batch(dim, batch_size);
+        for (int j = 0; j < batch_size; ++j) {
+            batch.col(j) = maximize_acquisition(n + j, best);
+            // Kriging believer: the proposal joins the model with its predicted value, which makes the
+            // expected improvement near it vanish, so the next proposal goes elsewhere.
+            if (j + 1 < batch_size) {
+                double sd;
+                double mean = predict(batch.col(j), n + j, sd);
+                append_sample(batch.col(j), value_mean + value_scale * mean, n + j);
+                solve_weights(n + j + 1);
+            }
+        }
+        add_batch(batch);
+        update_model();
+
+        checkpoint_if_due();
+    }
+
+    checkpoint_on_finish();
+}
+
+void Surrogate_opt::save_state(std::ostream& out) {
+    Optimization_method::save_state(out);
+
+    int dim = function->get_dim();
+    Checkpoint::write_value<uint32_t>(out, seed);
+    generator.save_state(out);
+    Checkpoint::write_value<double>(out, length_scale);
+    Checkpoint::write_value<int32_t>(out, num_of_fitted);
+    Checkpoint::write_value<int32_t>(out, num_of_samples);
+    out.write(reinterpret_cast<const char*>(samples.data()), static_cast<size_t>(dim) * num_of_samples * sizeof(double));
+    out.write(reinterpret_cast<const char*>(values.data()), num_of_samples * sizeof(double));
+}
+
+void Surrogate_opt::load_state(std::istream& in) {
+    Optimization_method::load_state(in);
+
+    int dim = function->get_dim();
+    seed = Checkpoint::read_value<uint32_t>(in);
+    generator.load_state(in);
+    length_scale = Checkpoint::read_value<double>(in);
+    num_of_fitted = Checkpoint::read_value<int32_t>(in);
+    num_of_samples = Checkpoint::read_value<int32_t>(in);
+    if (num_of_samples < 0 || num_of_fitted < 0)
+        throw std::runtime_error("Checkpoint is corrupted.");
+
+    int capacity = std::max(16, num_of_samples);
+    samples.resize(dim, capacity);
+    values.resize(capacity);
+    L.resize(capacity, capacity);
+    if (!in.read(reinterpret_cast<char*>(samples.data()), static_cast<size_t>(dim) * num_of_samples * sizeof(double))
+        || !in.read(reinterpret_cast<char*>(values.data()), num_of_samples * sizeof(double)))
+        throw std::runtime_error("Checkpoint file is truncated.");
+
+    // The factor is not stored: it is recomputed with the restored length scale.
+    if (num_of_samples > 0) {
+        factorize(num_of_samples);
+        update_model();
+    }
+}
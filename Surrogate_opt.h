@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include "Stop_criterion.h"
+#include "Optimization_method.h"
+#include "Sampler.h"
+#include "Thread_pool.h"
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <Eigen/Dense>
+
+/**
+ * @brief Surrogate-model optimization method class for expensive objective functions.
+ *
+ * Every evaluated point is kept, and a Gaussian process with the Matern 5/2 kernel is fitted to them in
+ * the coordinates of the box of the area scaled to the unit cube. The next point is the maximum of the
+ * expected improvement over the best value, found on the model alone by sampling the box and refining
+ * the best candidates with a compass search, so that the function is evaluated once per proposal. The
+ * search starts from x_0 and a Sobol design of 2 * dim more points.
+ *
+ * The Cholesky factor of the kernel matrix is extended by one row for every new point in O(n^2);
+ * only when the length scale is refitted by the marginal likelihood, after the number of points has
+ * grown by a tenth, is it recomputed in O(n^3). The method therefore suits budgets of up to a few
+ * hundred evaluations of a function costing far more than the model.
+ *
+ * With a batch size above one, an iteration proposes several points by the kriging believer
+ * heuristic: every proposal is added to the model with its predicted value before the next one is
+ * chosen. The points of a batch are evaluated in parallel on copies of the function (see Function::clone).
+ *
+ * One iteration is one batch. Stop criteria that use the gradient evaluate the function by finite
+ * differences, so the number of evaluations is best limited by Criterion_max_iter or Run_control.
+ */
+class Surrogate_opt : public Optimization_method {
+private:
+    int batch_size; /**< Number of points proposed and evaluated per iteration. */
+    unsigned seed; /**< Seed for random number generation. */
+    Xoshiro256 generator; /**< Random number generator. */
+    std::vector<std::pair<double, double>> box; /**< Bounding box of the area. */
+    std::unique_ptr<Thread_pool> pool; /**< Threads evaluating the batches. */
+    std::vector<Function*> clones; /**< Copy of the function for every thread, empty if the function cannot be copied. */
+
+    Eigen::MatrixXd samples; /**< Evaluated points scaled to the unit cube, one column per point; may hold spare columns. */
+    Eigen::VectorXd values; /**< Function values of the samples. */
+    int num_of_samples; /**< Number of evaluated points. */
+    Eigen::MatrixXd L; /**< Lower Cholesky factor of the kernel matrix in its top-left corner. */
+    Eigen::VectorXd weights; /**< Solution of K * weights = normalized values. */
+    double length_scale; /**< Length scale of the kernel in the unit cube. */
+    double value_mean; /**< Mean of the function values, subtracted before fitting. */
+    double value_scale; /**< Standard deviation of the function values, divided by before fitting. */
+    int num_of_fitted; /**< Number of samples at the last fit of the length scale. */
+
+    /**
+     * @brief Calculates the kernel of two points of the unit cube.
+     * @param a First point.
+     * @param b Second point.
+     * @return Covariance of the normalized values at the points.
+     */
+    double kernel(const double* a, const double* b) const;
+
+    /**
+     * @brief Adds a point to the samples and extends the Cholesky factor by its row.
+     * @param u Point in the unit cube.
+     * @param value Function value, true or predicted.
+     * @param index Index of the new sample; the factor must be valid for the samples before it.
+     */
+    void append_sample(const Eigen::VectorXd& u, double value, int index);
+
+    /**
+     * @brief Recomputes the Cholesky factor for the first n samples.
+     * @param n Number of samples.
+     * @return Logarithm of the marginal likelihood of the normalized values.
+     */
+    double factorize(int n);
+
+    /**
+     * @brief Recomputes the weights of the model for the first n samples.
+     * @param n Number of samples.
+     */
+    void solve_weights(int n);
+
+    /**
+     * @brief Refits the model to the evaluated points: normalizes the values, refits the length scale when due and solves the weights.
+     */
+    void update_model();
+
+    /**
+     * @brief Predicts the normalized function value at a point by the model of the first n samples.
+     * @param u Point in the unit cube.
+     * @param n Number of samples.
+     * @param sd Receives the standard deviation of the prediction.
+     * @return Mean of the prediction.
+     */
+    double predict(const Eigen::VectorXd& u, int n, double& sd) const;
+
+    /**
+     * @brief Calculates the expected improvement over a normalized value.
+     * @param u Point in the unit cube.
+     * @param n Number of samples.
+     * @param best Normalized best value.
+     * @return Expected improvement.
+     */
+    double expected_improvement(const Eigen::VectorXd& u, int n, double best) const;
+
+    /**
+     * @brief Finds the point of the box with the largest expected improvement.
+     * @param n Number of samples of the model.
+     * @param best Normalized best value.
+     * @return Point in the unit cube.
+     */
+    Eigen::VectorXd maximize_acquisition(int n, double best);
+
+    /**
+     * @brief Evaluates the function at the columns of a matrix, in parallel if possible.
+     * @param points Points, one column per point.
+     * @param f Receives the function values.
+     */
+    void evaluate_points(const Eigen::MatrixXd& points, Eigen::VectorXd& f);
+
+    /**
+     * @brief Evaluates a batch of points of the unit cube and adds them to the samples.
+     * @param batch Points in the unit cube, one column per point.
+     */
+    void add_batch(const Eigen::MatrixXd& batch);
+
+protected:
+    /**
+     * @brief Serializes the state of the search, including the samples and the random number generator.
+     * @param out Output stream.
+     */
+    void save_state(std::ostream& out) override;
+
+    /**
+     * @brief Restores the state written by save_state.
+     * @param in Input stream.
+     */
+    void load_state(std::istream& in) override;
+
+public:
+    /**
+     * @brief Constructor for the surrogate-model optimization method.
+     * @param function Pointer to the objective function.
+     * @param x_0 Initial point for optimization, the first sample.
+     * @param area Bounded area of the search.
+     * @param stop_criterion Pointer to the stopping criterion.
+     * @param batch_size_ Number of points evaluated per iteration.
+     * @param num_of_threads Number of threads evaluating the batches, 0 for the number of hardware threads.
+     */
+    Surrogate_opt(Function* function, std::vector<double> x_0, Area area, Stop_criterion* stop_criterion,
+        int batch_size_ = 1, int num_of_threads = 0);
+
+    /**
+     * @brief Destructor. Deletes the copies of the function.
+     */
+    ~Surrogate_opt();
+
+    /**
+     * @brief Sets the seed of the initial design and of the acquisition search.
+     * @param seed_ Seed.
+     */
+    void set_seed(unsigned seed_);
+
+    /**
+     * @brief Getter for the number of evaluated points.
+     * @return Number of samples of the model.
+     */
+    int get_num_of_samples();
+
+    /**
+     * @brief Getter for the length scale of the kernel.
+     * @return Length scale in the unit cube.
+     */
+    double get_length_scale();
+
+    /**
+     * @brief Perform the surrogate-model optimization.
+     */
+    void optimization() override;
+};
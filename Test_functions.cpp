@@ -0,0 +1,358 @@
+#include "Test_functions.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    const double pi = 3.14159265358979323846;
+}
+
+Test_function::Test_function(const int dimension) : Function(dimension) {
+    if (dimension < 1)
+        throw std::invalid_argument("Function dimension must be positive.");
+}
+
+double Test_function::get_optimal_f() const {
+    return value(get_optimum().data());
+}
+
+double Test_function::calculate(const std::vector<double>& x_) {
+    // The point is not stored: for large dimensions the copy would cost as much as the evaluation.
+    f = value(x_.data());
+    return f;
+}
+
+std::vector<double> Test_function::gradient(std::vector<double> x_, double, const Area&) {
+    std::vector<double> result(dim);
+    analytic_gradient(x_.data(), result.data());
+    return result;
+}
+
+std::vector<std::vector<double>> Test_function::hessian(std::vector<double> x_, double, const Area&) {
+    std::vector<std::vector<double>> result(dim, std::vector<double>(dim));
+    std::vector<double> e(dim, 0), column(dim);
+    for (int j = 0; j < dim; ++j) {
+        e[j] = 1;
+        hessian_vector(x_.data(), e.data(), column.data());
+        e[j] = 0;
+        for (int i = 0; i < dim; ++i) {
+            result[i][j] = column[i];
+        }
+    }
+    return result;
+}
+
+bool Test_function::has_analytic_derivatives() const {
+    return true;
+}
+
+
+Rosenbrock_function::Rosenbrock_function(const int dimension) : Test_function(dimension) {
+    if (dimension < 2)
+        throw std::invalid_argument("Rosenbrock function dimension must be at least 2.");
+}
+
+Function* Rosenbrock_function::clone() const {
+    return new Rosenbrock_function(*this);
+}
+
+double Rosenbrock_function::value(const double* x_) const {
+    double result = 0;
+    for (int i = 0; i < dim - 1; ++i) {
+        double t = x_[i + 1] - x_[i] * x_[i];
+        result += 100 * t * t + (x_[i] - 1) * (x_[i] - 1);
+    }
+    return result;
+}
+
+void Rosenbrock_function::analytic_gradient(const double* x_, double* g) const {
+    g[0] = 0;
+    for (int i = 0; i < dim - 1; ++i) {
+        double t = x_[i + 1] - x_[i] * x_[i];
+        g[i] += -400 * x_[i] * t + 2 * (x_[i] - 1);
+        g[i + 1] = 200 * t;
+    }
+}
+
+void Rosenbrock_function::hessian_vector(const double* x_, const double* v, double* hv) const {
+    // The Hessian matrix is tridiagonal.
+    for (int i = 0; i < dim; ++i) {
+        double diag = 0, result = 0;
+        if (i > 0) {
+            diag += 200;
+            result += -400 * x_[i - 1] * v[i - 1];
+        }
+        if (i < dim - 1) {
+            diag += 1200 * x_[i] * x_[i] - 400 * x_[i + 1] + 2;
+            result += -400 * x_[i] * v[i + 1];
+        }
+        hv[i] = result + diag * v[i];
+    }
+}
+
+std::vector<double> Rosenbrock_function::get_optimum() const {
+    return std::vector<double>(dim, 1);
+}
+
+Area Rosenbrock_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(dim, { -5, 10 }));
+}
+
+
+Rastrigin_function::Rastrigin_function(const int dimension) : Test_function(dimension) {}
+
+Function* Rastrigin_function::clone() const {
+    return new Rastrigin_function(*this);
+}
+
+double Rastrigin_function::value(const double* x_) const {
+    double result = 10.0 * dim;
+    for (int i = 0; i < dim; ++i) {
+        result += x_[i] * x_[i] - 10 * std::cos(2 * pi * x_[i]);
+    }
+    return result;
+}
+
+void Rastrigin_function::analytic_gradient(const double* x_, double* g) const {
+    for (int i = 0; i < dim; ++i) {
+        g[i] = 2 * x_[i] + 20 * pi * std::sin(2 * pi * x_[i]);
+    }
+}
+
+void Rastrigin_function::hessian_vector(const double* x_, const double* v, double* hv) const {
+    for (int i = 0; i < dim; ++i) {
+        hv[i] = (2 + 40 * pi * pi * std::cos(2 * pi * x_[i])) * v[i];
+    }
+}
+
+std::vector<double> Rastrigin_function::get_optimum() const {
+    return std::vector<double>(dim, 0);
+}
+
+Area Rastrigin_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(dim, { -5.12, 5.12 }));
+}
+
+
+Ackley_function::Ackley_function(const int dimension) : Test_function(dimension) {}
+
+Function* Ackley_function::clone() const {
+    return new Ackley_function(*this);
+}
+
+double Ackley_function::value(const double* x_) const {
+    double sum_sq = 0, sum_cos = 0;
+    for (int i = 0; i < dim; ++i) {
+        sum_sq += x_[i] * x_[i];
+        sum_cos += std::cos(2 * pi * x_[i]);
+    }
+    return -20 * std::exp(-0.2 * std::sqrt(sum_sq / dim)) - std::exp(sum_cos / dim) + 20 + std::exp(1.0);
+}
+
+void Ackley_function::analytic_gradient(const double* x_, double* g) const {
+    double sum_sq = 0, sum_cos = 0;
+    for (int i = 0; i < dim; ++i) {
+        sum_sq += x_[i] * x_[i];
+        sum_cos += std::cos(2 * pi * x_[i]);
+    }
+    double r = std::sqrt(sum_sq / dim);
+    double radial = r > 0 ? 4 * std::exp(-0.2 * r) / (dim * r) : 0;
+    double periodic = 2 * pi * std::exp(sum_cos / dim) / dim;
+    for (int i = 0; i < dim; ++i) {
+        g[i] = radial * x_[i] + periodic * std::sin(2 * pi * x_[i]);
+    }
+}
+
+void Ackley_function::hessian_vector(const double* x_, const double* v, double* hv) const {
+    // The Hessian matrix is diag + c_x * x x^T + c_s * s s^T with s_i = sin(2 * pi * x_i).
+    double sum_sq = 0, sum_cos = 0, x_v = 0, s_v = 0;
+    for (int i = 0; i < dim; ++i) {
+        sum_sq += x_[i] * x_[i];
+        sum_cos += std::cos(2 * pi * x_[i]);
+        x_v += x_[i] * v[i];
+        s_v += std::sin(2 * pi * x_[i]) * v[i];
+    }
+    double r = std::sqrt(sum_sq / dim);
+    double e_cos = std::exp(sum_cos / dim);
+    double u = 0, c_x = 0;
+    if (r > 0) {
+        double e_r = std::exp(-0.2 * r);
+        u = e_r / r;
+        c_x = -e_r * (0.2 / r + 1 / (r * r)) / (dim * r);
+    }
+    double c_diag = 4 * pi * pi * e_cos / dim;
+    for (int i = 0; i < dim; ++i) {
+        double s = std::sin(2 * pi * x_[i]);
+        hv[i] = 4.0 / dim * (u * v[i] + c_x * x_[i] * x_v)
+            + c_diag * (std::cos(2 * pi * x_[i]) * v[i] - s * s_v / dim);
+    }
+}
+
+std::vector<double> Ackley_function::get_optimum() const {
+    return std::vector<double>(dim, 0);
+}
+
+Area Ackley_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(dim, { -32.768, 32.768 }));
+}
+
+
+Powell_function::Powell_function(const int dimension) : Test_function(dimension) {
+    if (dimension % 4 != 0)
+        throw std::invalid_argument("Extended Powell function dimension must be a multiple of 4.");
+}
+
+Function* Powell_function::clone() const {
+    return new Powell_function(*this);
+}
+
+double Powell_function::value(const double* x_) const {
+    double result = 0;
+    for (int i = 0; i < dim; i += 4) {
+        double a = x_[i] + 10 * x_[i + 1], b = x_[i + 2] - x_[i + 3];
+        double c = x_[i + 1] - 2 * x_[i + 2], d = x_[i] - x_[i + 3];
+        result += a * a + 5 * b * b + c * c * c * c + 10 * d * d * d * d;
+    }
+    return result;
+}
+
+void Powell_function::analytic_gradient(const double* x_, double* g) const {
+    for (int i = 0; i < dim; i += 4) {
+        double a = x_[i] + 10 * x_[i + 1], b = x_[i + 2] - x_[i + 3];
+        double c = x_[i + 1] - 2 * x_[i + 2], d = x_[i] - x_[i + 3];
+        g[i] = 2 * a + 40 * d * d * d;
+        g[i + 1] = 20 * a + 4 * c * c * c;
+        g[i + 2] = 10 * b - 8 * c * c * c;
+        g[i + 3] = -10 * b - 40 * d * d * d;
+    }
+}
+
+void Powell_function::hessian_vector(const double* x_, const double* v, double* hv) const {
+    // The Hessian matrix is block diagonal with 4 x 4 blocks.
+    for (int i = 0; i < dim; i += 4) {
+        double c = x_[i + 1] - 2 * x_[i + 2], d = x_[i] - x_[i + 3];
+        double c2 = 12 * c * c, d2 = 120 * d * d;
+        double a_v = v[i] + 10 * v[i + 1], b_v = v[i + 2] - v[i + 3];
+        double c_v = v[i + 1] - 2 * v[i + 2], d_v = v[i] - v[i + 3];
+        hv[i] = 2 * a_v + d2 * d_v;
+        hv[i + 1] = 20 * a_v + c2 * c_v;
+        hv[i + 2] = 10 * b_v - 2 * c2 * c_v;
+        hv[i + 3] = -10 * b_v - d2 * d_v;
+    }
+}
+
+std::vector<double> Powell_function::get_optimum() const {
+    return std::vector<double>(dim, 0);
+}
+
+Area Powell_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(dim, { -4, 5 }));
+}
+
+
+Quadratic_function::Quadratic_function(const int dimension, double condition) : Test_function(dimension), lambda(dimension, 1) {
+    if (condition < 1)
+        throw std::invalid_argument("Condition number must be at least 1.");
+    for (int i = 1; i < dim; ++i) {
+        lambda[i] = std::pow(condition, static_cast<double>(i) / (dim - 1));
+    }
+}
+
+Function* Quadratic_function::clone() const {
+    return new Quadratic_function(*this);
+}
+
+double Quadratic_function::value(const double* x_) const {
+    double result = 0;
+    for (int i = 0; i < dim; ++i) {
+        result += lambda[i] * x_[i] * x_[i];
+    }
+    return 0.5 * result;
+}
+
+void Quadratic_function::analytic_gradient(const double* x_, double* g) const {
+    for (int i = 0; i < dim; ++i) {
+        g[i] = lambda[i] * x_[i];
+    }
+}
+
+void Quadratic_function::hessian_vector(const double*, const double* v, double* hv) const {
+    for (int i = 0; i < dim; ++i) {
+        hv[i] = lambda[i] * v[i];
+    }
+}
+
+std::vector<double> Quadratic_function::get_optimum() const {
+    return std::vector<double>(dim, 0);
+}
+
+Area Quadratic_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(dim, { -5, 5 }));
+}
+
+
+Styblinski_tang_function::Styblinski_tang_function(const int dimension) : Test_function(dimension) {}
+
+Function* Styblinski_tang_function::clone() const {
+    return new Styblinski_tang_function(*this);
+}
+
+double Styblinski_tang_function::value(const double* x_) const {
+    double result = 0;
+    for (int i = 0; i < dim; ++i) {
+        double x2 = x_[i] * x_[i];
+        result += x2 * x2 - 16 * x2 + 5 * x_[i];
+    }
+    return 0.5 * result;
+}
+
+void Styblinski_tang_function::analytic_gradient(const double* x_, double* g) const {
+    for (int i = 0; i < dim; ++i) {
+        g[i] = 2 * x_[i] * x_[i] * x_[i] - 16 * x_[i] + 2.5;
+    }
+}
+
+void Styblinski_tang_function::hessian_vector(const double* x_, const double* v, double* hv) const {
+    for (int i = 0; i < dim; ++i) {
+        hv[i] = (6 * x_[i] * x_[i] - 16) * v[i];
+    }
+}
+
+std::vector<double> Styblinski_tang_function::get_optimum() const {
+    return std::vector<double>(dim, -2.9035340276126953);
+}
+
+Area Styblinski_tang_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(dim, { -5, 5 }));
+}
+
+
+Himmelblau_function::Himmelblau_function() : Test_function(2) {}
+
+Function* Himmelblau_function::clone() const {
+    return new Himmelblau_function(*this);
+}
+
+double Himmelblau_function::value(const double* x_) const {
+    double a = x_[0] * x_[0] + x_[1] - 11, b = x_[0] + x_[1] * x_[1] - 7;
+    return a * a + b * b;
+}
+
+void Himmelblau_function::analytic_gradient(const double* x_, double* g) const {
+    double a = x_[0] * x_[0] + x_[1] - 11, b = x_[0] + x_[1] * x_[1] - 7;
+    g[0] = 4 * x_[0] * a + 2 * b;
+    g[1] = 2 * a + 4 * x_[1] * b;
+}
+
+void Himmelblau_function::hessian_vector(const double* x_, const double* v, double* hv) const {
+    double h00 = 12 * x_[0] * x_[0] + 4 * x_[1] - 42, h01 = 4 * (x_[0] + x_[1]), h11 = 4 * x_[0] + 12 * x_[1] * x_[1] - 26;
+    hv[0] = h00 * v[0] + h01 * v[1];
+    hv[1] = h01 * v[0] + h11 * v[1];
+}
+
+std::vector<double> Himmelblau_function::get_optimum() const {
+    return { 3, 2 };
+}
+
+Area Himmelblau_function::get_domain() const {
+    return Area(std::vector<std::pair<double, double>>(2, { -5, 5 }));
+}
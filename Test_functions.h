@@ -0,0 +1,235 @@
+#pragma once
+
+#include "Function.h"
+#include "Area.h"
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief Base class representing a benchmark function of arbitrary dimension with analytic derivatives.
+ *
+ * Derived classes work on raw arrays, so the cost of an evaluation, a gradient or a Hessian-vector
+ * product is O(dim) and the functions scale to dim = 10^6. The dense Hessian needs dim^2 memory and
+ * is meant for the dimensions Newton's method can handle.
+ */
+class Test_function : public Function {
+public:
+    /**
+     * @brief Constructor initializing the function with a specified dimension.
+     * @param dimension Dimension of the function.
+     */
+    explicit Test_function(const int dimension);
+
+    /**
+     * @brief Pure virtual function calculating the function value without counting the evaluation.
+     * @param x_ Array of dim coordinates.
+     * @return Function value.
+     */
+    virtual double value(const double* x_) const = 0;
+
+    /**
+     * @brief Pure virtual function calculating the gradient.
+     * @param x_ Array of dim coordinates.
+     * @param g Array of dim values receiving the gradient.
+     */
+    virtual void analytic_gradient(const double* x_, double* g) const = 0;
+
+    /**
+     * @brief Pure virtual function calculating the product of the Hessian matrix and a vector.
+     * @param x_ Array of dim coordinates.
+     * @param v Array of dim values.
+     * @param hv Array of dim values receiving the product.
+     */
+    virtual void hessian_vector(const double* x_, const double* v, double* hv) const = 0;
+
+    /**
+     * @brief Pure virtual function returning the global minimum.
+     * @return Point of the global minimum.
+     */
+    virtual std::vector<double> get_optimum() const = 0;
+
+    /**
+     * @brief Getter for the function value at the global minimum.
+     * @return Minimum function value.
+     */
+    double get_optimal_f() const;
+
+    /**
+     * @brief Pure virtual function returning the usual search domain of the function.
+     * @return Area containing the global minimum.
+     */
+    virtual Area get_domain() const = 0;
+
+    /**
+     * @brief Calculates the function value and stores it in f.
+     * @param x_ Point at which the function is evaluated.
+     * @return Function value.
+     */
+    double calculate(const std::vector<double>& x_) override;
+
+    /**
+     * @brief Calculates the exact gradient. The step and the area are ignored.
+     * @param x_ Point at which the gradient is calculated.
+     * @param h Ignored.
+     * @param a Ignored.
+     * @return Gradient vector.
+     */
+    std::vector<double> gradient(std::vector<double> x_, double h, const Area& a) override;
+
+    /**
+     * @brief Calculates the exact Hessian matrix column by column with hessian_vector. The step and the area are ignored.
+     * @param x_ Point at which the Hessian is calculated.
+     * @param h Ignored.
+     * @param a Ignored.
+     * @return Hessian matrix.
+     */
+    std::vector<std::vector<double>> hessian(std::vector<double> x_, double h, const Area& a) override;
+
+    /**
+     * @brief Checks whether the derivatives are analytic.
+     * @return True.
+     */
+    bool has_analytic_derivatives() const override;
+};
+
+/**
+ * @brief Generalized Rosenbrock function: sum of 100 * (x_{i+1} - x_i^2)^2 + (x_i - 1)^2, minimum 0 at (1, ..., 1).
+ */
+class Rosenbrock_function : public Test_function {
+public:
+    /**
+     * @brief Constructor for the Rosenbrock function.
+     * @param dimension Dimension of the function, at least 2.
+     */
+    explicit Rosenbrock_function(const int dimension);
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
+
+/**
+ * @brief Rastrigin function: 10 * dim + sum of x_i^2 - 10 * cos(2 * pi * x_i), minimum 0 at the origin.
+ */
+class Rastrigin_function : public Test_function {
+public:
+    /**
+     * @brief Constructor for the Rastrigin function.
+     * @param dimension Dimension of the function.
+     */
+    explicit Rastrigin_function(const int dimension);
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
+
+/**
+ * @brief Ackley function with a = 20, b = 0.2, c = 2 * pi, minimum 0 at the origin.
+ * The function is not differentiable at the origin; the gradient there is taken as zero.
+ */
+class Ackley_function : public Test_function {
+public:
+    /**
+     * @brief Constructor for the Ackley function.
+     * @param dimension Dimension of the function.
+     */
+    explicit Ackley_function(const int dimension);
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
+
+/**
+ * @brief Extended Powell singular function, minimum 0 at the origin where the Hessian is singular.
+ * Every group of four coordinates adds (x_1 + 10 x_2)^2 + 5 (x_3 - x_4)^2 + (x_2 - 2 x_3)^4 + 10 (x_1 - x_4)^4.
+ */
+class Powell_function : public Test_function {
+public:
+    /**
+     * @brief Constructor for the extended Powell function.
+     * @param dimension Dimension of the function, a multiple of 4.
+     */
+    explicit Powell_function(const int dimension);
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
+
+/**
+ * @brief Separable quadratic function 0.5 * sum of lambda_i * x_i^2, minimum 0 at the origin.
+ * The eigenvalues lambda_i = condition^(i / (dim - 1)) are spread geometrically from 1 to the condition number.
+ */
+class Quadratic_function : public Test_function {
+private:
+    std::vector<double> lambda; /**< Eigenvalues of the Hessian matrix. */
+
+public:
+    /**
+     * @brief Constructor for the quadratic function.
+     * @param dimension Dimension of the function.
+     * @param condition Condition number of the Hessian matrix, at least 1.
+     */
+    Quadratic_function(const int dimension, double condition = 1e3);
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
+
+/**
+ * @brief Styblinski-Tang function 0.5 * sum of x_i^4 - 16 x_i^2 + 5 x_i with 2^dim local minima.
+ * The global minimum is at x_i = -2.903534... with the value -39.166165... * dim.
+ */
+class Styblinski_tang_function : public Test_function {
+public:
+    /**
+     * @brief Constructor for the Styblinski-Tang function.
+     * @param dimension Dimension of the function.
+     */
+    explicit Styblinski_tang_function(const int dimension);
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
+
+/**
+ * @brief Himmelblau function (x^2 + y - 11)^2 + (x + y^2 - 7)^2 of two variables.
+ * It has four minima with the value 0, at (3, 2), (-2.805118, 3.131312), (-3.779310, -3.283186) and
+ * (3.584428, -1.848126), as well as four saddle points and a maximum in [-5, 5]^2.
+ */
+class Himmelblau_function : public Test_function {
+public:
+    /**
+     * @brief Constructor for the Himmelblau function.
+     */
+    Himmelblau_function();
+
+    Function* clone() const override;
+    double value(const double* x_) const override;
+    void analytic_gradient(const double* x_, double* g) const override;
+    void hessian_vector(const double* x_, const double* v, double* hv) const override;
+    std::vector<double> get_optimum() const override;
+    Area get_domain() const override;
+};
@@ -0,0 +1,87 @@
+#include "Thread_pool.h"
+
+Thread_pool::Thread_pool(int num_of_threads) : num_of_items(0), generation(0), num_of_running(0), is_stopping(false) {
+    if (num_of_threads <= 0)
+        num_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int t = 1; t < num_of_threads; ++t) {
+        workers.emplace_back(&Thread_pool::work, this, t);
+    }
+}
+
+Thread_pool::~Thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    cv_start.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int Thread_pool::get_num_of_threads() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void Thread_pool::run_part(int thread) {
+    int num_of_threads = get_num_of_threads();
+    int begin = static_cast<int>(static_cast<long long>(num_of_items) * thread / num_of_threads);
+    int end = static_cast<int>(static_cast<long long>(num_of_items) * (thread + 1) / num_of_threads);
+    if (begin == end)
+        return;
+
+    try {
+        body(begin, end, thread);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+    }
+}
+
+void Thread_pool::work(int thread) {
+    int seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv_start.wait(lock, [&] { return is_stopping || generation != seen_generation; });
+            if (is_stopping)
+                return;
+            seen_generation = generation;
+        }
+
+        run_part(thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--num_of_running == 0)
+            cv_done.notify_one();
+    }
+}
+
+void Thread_pool::parallel_for(int n, const std::function<void(int, int, int)>& body_) {
+    if (workers.empty()) {
+        if (n > 0)
+            body_(0, n, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        body = body_;
+        num_of_items = n;
+        num_of_running = static_cast<int>(workers.size());
+        error = nullptr;
+        ++generation;
+    }
+    cv_start.notify_all();
+
+    run_part(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv_done.wait(lock, [this] { return num_of_running == 0; });
+    body = nullptr;
+    if (error)
+        std::rethrow_exception(error);
+}
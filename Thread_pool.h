@@ -0,0 +1,70 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+/**
+ * @brief Class keeping a fixed set of worker threads for parallel loops.
+ *
+ * The calling thread takes part in every loop as thread 0, so a pool of one thread runs the loop inline.
+ */
+class Thread_pool {
+private:
+    std::vector<std::thread> workers; /**< Worker threads 1..num_of_threads - 1. */
+    std::mutex mutex; /**< Mutex guarding the loop state. */
+    std::condition_variable cv_start; /**< Signals the workers that a new loop has started. */
+    std::condition_variable cv_done; /**< Signals the caller that a worker has finished its part. */
+    std::function<void(int, int, int)> body; /**< Body of the current loop. */
+    int num_of_items; /**< Number of items of the current loop. */
+    int generation; /**< Number of loops started so far. */
+    int num_of_running; /**< Number of workers still working on the current loop. */
+    bool is_stopping; /**< True if the workers must exit. */
+    std::exception_ptr error; /**< First exception thrown by the current loop. */
+
+    /**
+     * @brief Runs the part of the current loop that belongs to a thread.
+     * @param thread Index of the thread.
+     */
+    void run_part(int thread);
+
+    /**
+     * @brief Loop of a worker thread.
+     * @param thread Index of the thread.
+     */
+    void work(int thread);
+
+public:
+    /**
+     * @brief Constructor starting the workers.
+     * @param num_of_threads Number of threads including the caller, 0 for the number of hardware threads.
+     */
+    explicit Thread_pool(int num_of_threads = 0);
+
+    /**
+     * @brief Destructor. Stops the workers.
+     */
+    ~Thread_pool();
+
+    Thread_pool(const Thread_pool&) = delete;
+    Thread_pool& operator=(const Thread_pool&) = delete;
+
+    /**
+     * @brief Getter for the number of threads including the caller.
+     * @return Number of threads.
+     */
+    int get_num_of_threads() const;
+
+    /**
+     * @brief Splits the range [0, n) into one contiguous part per thread and runs them in parallel.
+     * Returns when all parts are done; rethrows the first exception thrown by the body.
+     * @param n Number of items.
+     * @param body_ Function called as body_(begin, end, thread) for every non-empty part.
+     */
+    void parallel_for(int n, const std::function<void(int, int, int)>& body_);
+};
@@ -0,0 +1,101 @@
+#include "Trace.h"
+#include <fstream>
+#include <mutex>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Trace::Thread_buffer>> registry; // Buffers of all threads that have recorded events.
+    int64_t epoch = 0; // Trace clock value of the first start().
+    thread_local Trace::Thread_buffer* thread_buffer = nullptr;
+    // Incremented by clear(), so threads drop their pointers to deleted buffers.
+    std::atomic<int> generation(0);
+    thread_local int thread_generation = -1;
+}
+
+std::atomic<bool> Trace::is_enabled_flag(false);
+
+Trace::Thread_buffer& Trace::get_buffer() {
+    int current = generation.load(std::memory_order_acquire);
+    if (thread_buffer == nullptr || thread_generation != current) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.emplace_back(new Thread_buffer());
+        thread_buffer = registry.back().get();
+        thread_buffer->tid = static_cast<int>(registry.size());
+        thread_buffer->size = 0;
+        thread_generation = current;
+    }
+    return *thread_buffer;
+}
+
+void Trace::start() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (epoch == 0)
+        epoch = now();
+    is_enabled_flag.store(true);
+}
+
+void Trace::stop() {
+    is_enabled_flag.store(false);
+}
+
+void Trace::clear() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.clear();
+    epoch = 0;
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+void Trace::record(const char* name, int64_t start, int64_t end) {
+    Thread_buffer& buffer = get_buffer();
+    size_t chunk = buffer.size / chunk_size;
+    if (chunk == buffer.chunks.size())
+        buffer.chunks.emplace_back(new Event[chunk_size]);
+
+    Event& event = buffer.chunks[chunk][buffer.size % chunk_size];
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+    ++buffer.size;
+}
+
+size_t Trace::get_num_of_events() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    size_t result = 0;
+    for (const std::unique_ptr<Thread_buffer>& buffer : registry) {
+        result += buffer->size;
+    }
+    return result;
+}
+
+void Trace::write_json(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool is_first = true;
+    char line[256];
+    for (const std::unique_ptr<Thread_buffer>& buffer : registry) {
+        // Names the thread in the viewer.
+        snprintf(line, sizeof(line), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            is_first ? "" : ",", buffer->tid, buffer->tid);
+        out << line;
+        is_first = false;
+
+        for (size_t k = 0; k < buffer->size; ++k) {
+            const Event& event = buffer->chunks[k / chunk_size][k % chunk_size];
+            // Times are in microseconds; names are string literals without characters to escape.
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                event.name, buffer->tid, (event.start - epoch) / 1000.0, event.duration / 1000.0);
+            out << line;
+        }
+    }
+    out << "\n]}\n";
+}
+
+void Trace::write_json(const std::string& path) {
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot open trace file " + path + ".");
+    write_json(out);
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Timeline of scoped events exported in the Chrome trace-event format (chrome://tracing, Perfetto).
+ *
+ * Every thread records into its own buffer, so recording takes no locks; a lock is taken only once per
+ * thread to register the buffer. Recording is off until start() is called; while it is off a scope
+ * costs one relaxed atomic load. Defining NEWTON_OPT_NO_TRACE removes the TRACE_SCOPE macros entirely.
+ * write_json() must be called when no thread is recording, e.g. after stop() and the end of the runs.
+ */
+class Trace {
+public:
+    /**
+     * @brief Complete event: a named interval on one thread.
+     */
+    struct Event {
+        const char* name; /**< Name of the event, a string literal. */
+        int64_t start; /**< Start in nanoseconds since the trace epoch. */
+        int64_t duration; /**< Duration in nanoseconds. */
+    };
+
+    /**
+     * @brief Events of one thread, stored in chunks so that recording never moves old events.
+     */
+    struct Thread_buffer {
+        int tid; /**< Index of the thread in the trace. */
+        std::vector<std::unique_ptr<Event[]>> chunks; /**< Chunks of chunk_size events. */
+        size_t size; /**< Number of recorded events. */
+    };
+
+    static const size_t chunk_size = 4096; /**< Number of events per chunk. */
+
+private:
+    static std::atomic<bool> is_enabled_flag; /**< True while events are recorded. */
+
+    /**
+     * @brief Getter for the buffer of the calling thread, registering it on first use.
+     * @return Buffer of the calling thread.
+     */
+    static Thread_buffer& get_buffer();
+
+public:
+    /**
+     * @brief Checks whether events are recorded.
+     * @return True while tracing is on.
+     */
+    static bool is_enabled() {
+        return is_enabled_flag.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Getter for the current time on the trace clock.
+     * @return Nanoseconds since the trace epoch.
+     */
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Starts recording events.
+     */
+    static void start();
+
+    /**
+     * @brief Stops recording events. Recorded events are kept.
+     */
+    static void stop();
+
+    /**
+     * @brief Discards all recorded events. No thread may be recording.
+     */
+    static void clear();
+
+    /**
+     * @brief Records a complete event on the calling thread.
+     * @param name Name of the event, a string literal.
+     * @param start Start on the trace clock.
+     * @param end End on the trace clock.
+     */
+    static void record(const char* name, int64_t start, int64_t end);
+
+    /**
+     * @brief Getter for the number of recorded events of all threads.
+     * @return Number of events.
+     */
+    static size_t get_num_of_events();
+
+    /**
+     * @brief Writes all recorded events as Chrome trace-event JSON.
+     * @param out Output stream.
+     */
+    static void write_json(std::ostream& out);
+
+    /**
+     * @brief Writes all recorded events as Chrome trace-event JSON to a file.
+     * @param path Path to the file.
+     */
+    static void write_json(const std::string& path);
+};
+
+/**
+ * @brief Records the lifetime of the object as a trace event if tracing is on at its construction.
+ */
+class Trace_scope {
+private:
+    const char* name; /**< Name of the event, null if tracing was off. */
+    int64_t start; /**< Start on the trace clock. */
+
+public:
+    /**
+     * @brief Constructor starting the event.
+     * @param name_ Name of the event, a string literal.
+     */
+    explicit Trace_scope(const char* name_) : name(nullptr), start(0) {
+        if (Trace::is_enabled()) {
+            name = name_;
+            start = Trace::now();
+        }
+    }
+
+    /**
+     * @brief Destructor recording the event.
+     */
+    ~Trace_scope() {
+        if (name != nullptr)
+            Trace::record(name, start, Trace::now());
+    }
+
+    Trace_scope(const Trace_scope&) = delete;
+    Trace_scope& operator=(const Trace_scope&) = delete;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef NEWTON_OPT_NO_TRACE
+#define TRACE_SCOPE(name)
+#else
+/**
+ * @brief Records the rest of the enclosing block as a trace event with the given name.
+ */
+#define TRACE_SCOPE(name) Trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#endif
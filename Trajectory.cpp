@@ -0,0 +1,306 @@
+#include "Trajectory.h"
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint32_t trajectory_magic = 0x4A52544E; // "NTRJ"
+    const uint32_t trajectory_version = 1;
+    const size_t header_size = 24;
+
+    size_t align8(size_t n) {
+        return (n + 7) & ~static_cast<size_t>(7);
+    }
+}
+
+const double* Trajectory_block::get_x(int i) const {
+    return x + i * size;
+}
+
+
+Trajectory_writer::Trajectory_writer(const std::string& path, int dim_, size_t block_size_, bool is_background_)
+    : out(path, std::ios::binary | std::ios::trunc), dim(dim_), block_size(block_size_),
+    is_background(is_background_), is_closed(false) {
+    if (!out)
+        throw std::runtime_error("Cannot open trajectory file " + path + ".");
+    if (dim <= 0 || block_size == 0)
+        throw std::invalid_argument("Trajectory dimension and block size must be positive.");
+
+    uint32_t header32[] = { trajectory_magic, trajectory_version, static_cast<uint32_t>(dim), 0 };
+    uint64_t header64 = block_size;
+    out.write(reinterpret_cast<const char*>(header32), sizeof(header32));
+    out.write(reinterpret_cast<const char*>(&header64), sizeof(header64));
+
+    current = make_buffer();
+    if (is_background)
+        thread = std::thread(&Trajectory_writer::run, this);
+}
+
+Trajectory_writer::~Trajectory_writer() {
+    try {
+        close();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+int Trajectory_writer::get_dim() const {
+    return dim;
+}
+
+Trajectory_writer::Buffer Trajectory_writer::make_buffer() {
+    Buffer buffer;
+    buffer.size = 0;
+    buffer.iter.resize(block_size);
+    buffer.f.resize(block_size);
+    buffer.x.resize(block_size * dim);
+    buffer.accepted.resize(block_size);
+    return buffer;
+}
+
+void Trajectory_writer::record(const double* x, double f, int64_t iter, bool accepted) {
+    size_t k = current.size;
+    current.iter[k] = iter;
+    current.f[k] = f;
+    for (int i = 0; i < dim; ++i) {
+        current.x[i * block_size + k] = x[i];
+    }
+    current.accepted[k] = accepted;
+
+    if (++current.size == block_size)
+        flush_block();
+}
+
+void Trajectory_writer::write_block(const Buffer& buffer) {
+    uint64_t n = buffer.size;
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    out.write(reinterpret_cast<const char*>(buffer.iter.data()), n * sizeof(int64_t));
+    out.write(reinterpret_cast<const char*>(buffer.f.data()), n * sizeof(double));
+    for (int i = 0; i < dim; ++i) {
+        out.write(reinterpret_cast<const char*>(buffer.x.data() + i * block_size), n * sizeof(double));
+    }
+    out.write(reinterpret_cast<const char*>(buffer.accepted.data()), n);
+
+    static const char padding[8] = {};
+    out.write(padding, align8(n) - n);
+}
+
+void Trajectory_writer::flush_block() {
+    if (current.size == 0)
+        return;
+
+    if (!is_background) {
+        write_block(current);
+        current.size = 0;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // Keep the memory bounded if the disk is slower than the optimization.
+    cv.wait(lock, [this] { return queue.size() < 4; });
+    queue.push_back(std::move(current));
+    if (!free_buffers.empty()) {
+        current = std::move(free_buffers.back());
+        free_buffers.pop_back();
+        current.size = 0;
+    }
+    else {
+        lock.unlock();
+        current = make_buffer();
+    }
+    cv.notify_all();
+}
+
+void Trajectory_writer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return !queue.empty() || is_closed; });
+        if (queue.empty())
+            break;
+
+        Buffer buffer = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        write_block(buffer);
+        lock.lock();
+        free_buffers.push_back(std::move(buffer));
+        cv.notify_all();
+    }
+}
+
+void Trajectory_writer::close() {
+    if (is_closed)
+        return;
+
+    flush_block();
+    if (is_background) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_closed = true;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+    is_closed = true;
+
+    out.close();
+    if (out.fail())
+        throw std::runtime_error("Cannot write trajectory file.");
+}
+
+
+Trajectory_reader::Trajectory_reader(const std::string& path) : data(nullptr), file_size(0), dim(0), block_size(0), size(0) {
+#ifdef _WIN32
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open trajectory file " + path + ".");
+    LARGE_INTEGER large_size;
+    GetFileSizeEx(file_handle, &large_size);
+    file_size = static_cast<size_t>(large_size.QuadPart);
+    mapping_handle = nullptr;
+    if (file_size > 0) {
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle != nullptr)
+            data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        if (data == nullptr) {
+            if (mapping_handle != nullptr)
+                CloseHandle(mapping_handle);
+            CloseHandle(file_handle);
+            throw std::runtime_error("Cannot map trajectory file " + path + ".");
+        }
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open trajectory file " + path + ".");
+    struct stat st;
+    fstat(fd, &st);
+    file_size = static_cast<size_t>(st.st_size);
+    if (file_size > 0) {
+        void* p = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Cannot map trajectory file " + path + ".");
+        data = static_cast<const char*>(p);
+    }
+    else {
+        ::close(fd);
+    }
+#endif
+
+    uint32_t header32[4];
+    uint64_t header64;
+    if (file_size < header_size) {
+        unmap();
+        throw std::runtime_error("Trajectory file is truncated.");
+    }
+    std::memcpy(header32, data, sizeof(header32));
+    std::memcpy(&header64, data + sizeof(header32), sizeof(header64));
+    if (header32[0] != trajectory_magic || header32[1] != trajectory_version) {
+        unmap();
+        throw std::runtime_error("Unsupported trajectory format.");
+    }
+    dim = static_cast<int>(header32[2]);
+    block_size = static_cast<size_t>(header64);
+
+    // A block cut off by a killed process is ignored, the complete blocks before it stay readable.
+    size_t offset = header_size;
+    while (offset + sizeof(uint64_t) <= file_size) {
+        uint64_t n;
+        std::memcpy(&n, data + offset, sizeof(n));
+        size_t block_bytes = sizeof(uint64_t) + n * (2 + dim) * sizeof(double) + align8(n);
+        if (n == 0 || n > block_size || offset + block_bytes > file_size)
+            break;
+
+        Trajectory_block block;
+        const char* p = data + offset + sizeof(uint64_t);
+        block.size = n;
+        block.iter = reinterpret_cast<const int64_t*>(p);
+        block.f = reinterpret_cast<const double*>(p + n * sizeof(int64_t));
+        block.x = reinterpret_cast<const double*>(p + 2 * n * sizeof(double));
+        block.accepted = reinterpret_cast<const uint8_t*>(p + (2 + dim) * n * sizeof(double));
+        blocks.push_back(block);
+        block_starts.push_back(size);
+
+        size += n;
+        offset += block_bytes;
+    }
+}
+
+Trajectory_reader::~Trajectory_reader() {
+    unmap();
+}
+
+void Trajectory_reader::unmap() {
+#ifdef _WIN32
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mapping_handle != nullptr)
+        CloseHandle(mapping_handle);
+    if (file_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = INVALID_HANDLE_VALUE;
+#else
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), file_size);
+#endif
+    data = nullptr;
+}
+
+int Trajectory_reader::get_dim() const {
+    return dim;
+}
+
+size_t Trajectory_reader::get_size() const {
+    return size;
+}
+
+size_t Trajectory_reader::get_num_of_blocks() const {
+    return blocks.size();
+}
+
+const Trajectory_block& Trajectory_reader::get_block(size_t i) const {
+    return blocks.at(i);
+}
+
+const Trajectory_block& Trajectory_reader::find_block(size_t k, size_t& offset) const {
+    if (k >= size)
+        throw std::out_of_range("Trajectory record index is out of range.");
+    // The format allows a block of fewer than block_size records anywhere in the file, so k / block_size may miss.
+    size_t i = static_cast<size_t>(std::upper_bound(block_starts.begin(), block_starts.end(), k) - block_starts.begin()) - 1;
+    offset = k - block_starts[i];
+    return blocks[i];
+}
+
+double Trajectory_reader::get_f(size_t k) const {
+    size_t offset;
+    const Trajectory_block& block = find_block(k, offset);
+    return block.f[offset];
+}
+
+double Trajectory_reader::get_x(size_t k, int i) const {
+    size_t offset;
+    const Trajectory_block& block = find_block(k, offset);
+    return block.get_x(i)[offset];
+}
+
+int64_t Trajectory_reader::get_iter(size_t k) const {
+    size_t offset;
+    const Trajectory_block& block = find_block(k, offset);
+    return block.iter[offset];
+}
+
+bool Trajectory_reader::is_accepted(size_t k) const {
+    size_t offset;
+    const Trajectory_block& block = find_block(k, offset);
+    return block.accepted[offset] != 0;
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Block of records of a trajectory stored by columns.
+ *
+ * The trajectory file consists of a header followed by blocks. Every block starts with the number
+ * of records and then contains the columns one after another: iteration numbers, function values,
+ * one column per coordinate of x and the accepted flags. Each column is aligned to 8 bytes, so
+ * the columns can be used directly from a memory-mapped file.
+ */
+struct Trajectory_block {
+    size_t size; /**< Number of records in the block. */
+    const int64_t* iter; /**< Iteration numbers. */
+    const double* f; /**< Function values. */
+    const double* x; /**< Coordinates, column-major: coordinate i of record k is x[i * size + k]. */
+    const uint8_t* accepted; /**< 1 if the point was accepted as the next iterate, 0 otherwise. */
+
+    /**
+     * @brief Getter for one coordinate column.
+     * @param i Index of the coordinate.
+     * @return Pointer to the values of coordinate i for all records of the block.
+     */
+    const double* get_x(int i) const;
+};
+
+/**
+ * @brief Class streaming the points evaluated by an optimization method to a binary file.
+ *
+ * Records are appended to an in-memory block; a full block is written to the file either directly
+ * or by a background thread, so recording a point costs only a few stores.
+ */
+class Trajectory_writer {
+private:
+    /**
+     * @brief In-memory block being filled or waiting to be written.
+     */
+    struct Buffer {
+        size_t size; /**< Number of records in the buffer. */
+        std::vector<int64_t> iter; /**< Iteration numbers. */
+        std::vector<double> f; /**< Function values. */
+        std::vector<double> x; /**< Coordinates, column-major with stride block_size. */
+        std::vector<uint8_t> accepted; /**< Accepted flags. */
+    };
+
+    std::ofstream out; /**< Output file. */
+    int dim; /**< Dimension of the recorded points. */
+    size_t block_size; /**< Number of records in a full block. */
+    bool is_background; /**< True if blocks are written by the background thread. */
+    Buffer current; /**< Block being filled. */
+    std::deque<Buffer> queue; /**< Full blocks waiting for the background thread. */
+    std::vector<Buffer> free_buffers; /**< Written blocks kept for reuse. */
+    std::thread thread; /**< Background writing thread. */
+    std::mutex mutex; /**< Mutex guarding the queue and the free buffers. */
+    std::condition_variable cv; /**< Condition variable signalling queue changes. */
+    bool is_closed; /**< True after close() has been called. */
+
+    /**
+     * @brief Allocates an empty buffer of block_size records.
+     * @return Empty buffer.
+     */
+    Buffer make_buffer();
+
+    /**
+     * @brief Writes one block to the file.
+     * @param buffer Block to be written.
+     */
+    void write_block(const Buffer& buffer);
+
+    /**
+     * @brief Hands the current block to the background thread or writes it directly.
+     */
+    void flush_block();
+
+    /**
+     * @brief Loop of the background writing thread.
+     */
+    void run();
+
+public:
+    /**
+     * @brief Constructor opening the trajectory file.
+     * @param path Path of the trajectory file.
+     * @param dim_ Dimension of the recorded points.
+     * @param block_size_ Number of records in one block.
+     * @param is_background_ If true, blocks are written by a background thread.
+     */
+    Trajectory_writer(const std::string& path, int dim_, size_t block_size_ = 4096, bool is_background_ = true);
+
+    /**
+     * @brief Destructor. Writes the remaining records and closes the file.
+     */
+    ~Trajectory_writer();
+
+    Trajectory_writer(const Trajectory_writer&) = delete;
+    Trajectory_writer& operator=(const Trajectory_writer&) = delete;
+
+    /**
+     * @brief Getter for the dimension of the recorded points.
+     * @return Dimension of the recorded points.
+     */
+    int get_dim() const;
+
+    /**
+     * @brief Appends one point to the trajectory.
+     * @param x Coordinates of the point, dim values.
+     * @param f Function value at the point.
+     * @param iter Iteration at which the point was evaluated.
+     * @param accepted True if the point became the next iterate.
+     */
+    void record(const double* x, double f, int64_t iter, bool accepted);
+
+    /**
+     * @brief Writes the remaining records, stops the background thread and closes the file.
+     */
+    void close();
+};
+
+/**
+ * @brief Class giving read-only access to a trajectory file through a memory mapping.
+ *
+ * The blocks returned by the reader point directly into the mapped file, no data is copied.
+ */
+class Trajectory_reader {
+private:
+    const char* data; /**< Start of the mapped file. */
+    size_t file_size; /**< Size of the mapped file in bytes. */
+    int dim; /**< Dimension of the recorded points. */
+    size_t block_size; /**< Number of records in a full block. */
+    size_t size; /**< Total number of records. */
+    std::vector<Trajectory_block> blocks; /**< Views of all complete blocks in the file. */
+    std::vector<size_t> block_starts; /**< Index of the first record of every block. */
+#ifdef _WIN32
+    void* file_handle; /**< Handle of the opened file. */
+    void* mapping_handle; /**< Handle of the file mapping. */
+#endif
+
+    /**
+     * @brief Unmaps the file and closes its handles.
+     */
+    void unmap();
+
+    /**
+     * @brief Finds the block holding a record.
+     * @param k Index of the record.
+     * @param offset Receives the position of the record in the block.
+     * @return Block holding record k.
+     */
+    const Trajectory_block& find_block(size_t k, size_t& offset) const;
+
+public:
+    /**
+     * @brief Constructor mapping a trajectory file.
+     * @param path Path of the trajectory file.
+     */
+    explicit Trajectory_reader(const std::string& path);
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~Trajectory_reader();
+
+    Trajectory_reader(const Trajectory_reader&) = delete;
+    Trajectory_reader& operator=(const Trajectory_reader&) = delete;
+
+    /**
+     * @brief Getter for the dimension of the recorded points.
+     * @return Dimension of the recorded points.
+     */
+    int get_dim() const;
+
+    /**
+     * @brief Getter for the total number of records.
+     * @return Number of records in the file.
+     */
+    size_t get_size() const;
+
+    /**
+     * @brief Getter for the number of blocks.
+     * @return Number of blocks in the file.
+     */
+    size_t get_num_of_blocks() const;
+
+    /**
+     * @brief Getter for a block of records.
+     * @param i Index of the block.
+     * @return View of the block pointing into the mapped file.
+     */
+    const Trajectory_block& get_block(size_t i) const;
+
+    /**
+     * @brief Getter for the function value of a record.
+     * @param k Index of the record.
+     * @return Function value of record k.
+     */
+    double get_f(size_t k) const;
+
+    /**
+     * @brief Getter for one coordinate of a record.
+     * @param k Index of the record.
+     * @param i Index of the coordinate.
+     * @return Coordinate i of record k.
+     */
+    double get_x(size_t k, int i) const;
+
+    /**
+     * @brief Getter for the iteration number of a record.
+     * @param k Index of the record.
+     * @return Iteration at which record k was evaluated.
+     */
+    int64_t get_iter(size_t k) const;
+
+    /**
+     * @brief Checks whether a record was accepted as an iterate.
+     * @param k Index of the record.
+     * @return True if record k was accepted, false otherwise.
+     */
+    bool is_accepted(size_t k) const;
+};
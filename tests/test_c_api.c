@@ -0,0 +1,57 @@
+#include "Newton_opt_api.h"
+#include <stdio.h>
+#include <math.h>
+
+/**
+ * @brief Booth function (x_1 + 2 x_2 - 7)^2 + (2 x_1 + x_2 - 5)^2 with the minimum 0 at (1, 3).
+ */
+static double booth(const double* x, int dim, void* user_data) {
+    double a = x[0] + 2 * x[1] - 7, b = 2 * x[0] + x[1] - 5;
+    (void)dim;
+    ++*(long long*)user_data;
+    return a * a + b * b;
+}
+
+int main(void) {
+    const double lower[2] = { -10, -10 }, upper[2] = { 10, 10 }, x_0[2] = { 5, -5 };
+    long long num_of_calls = 0;
+    int num_of_failed = 0;
+    double x[2] = { 0, 0 };
+
+    newton_opt_problem problem;
+    problem.struct_size = sizeof(newton_opt_problem);
+    problem.dim = 2;
+    problem.objective = booth;
+    problem.batch_objective = NULL;
+    problem.user_data = &num_of_calls;
+    problem.lower = lower;
+    problem.upper = upper;
+
+    newton_opt_options options;
+    options.struct_size = sizeof(newton_opt_options);
+    if (newton_opt_default_options(&options) != NEWTON_OPT_OK || options.method != NEWTON_OPT_NEWTON) {
+        fprintf(stderr, "Default options are not filled: %s\n", newton_opt_last_error());
+        ++num_of_failed;
+    }
+
+    newton_opt_result result;
+    result.struct_size = sizeof(newton_opt_result);
+    if (newton_opt_minimize(&problem, x_0, &options, x, &result) != NEWTON_OPT_OK) {
+        fprintf(stderr, "Minimization failed: %s\n", newton_opt_last_error());
+        ++num_of_failed;
+    }
+    else if (fabs(x[0] - 1) > 1e-6 || fabs(x[1] - 3) > 1e-6 || result.f > 1e-10 ||
+        result.num_of_evaluations <= 0 || result.num_of_evaluations > num_of_calls) {
+        fprintf(stderr, "Unexpected result: x = (%g, %g), f = %g, %lld evaluations of %lld calls\n",
+            x[0], x[1], result.f, result.num_of_evaluations, num_of_calls);
+        ++num_of_failed;
+    }
+
+    /* A problem without its size is rejected with a message instead of being read. */
+    problem.struct_size = 0;
+    if (newton_opt_minimize(&problem, x_0, NULL, x, NULL) != NEWTON_OPT_INVALID_ARGUMENT || newton_opt_last_error()[0] == '\0') {
+        fprintf(stderr, "A problem without struct_size is not rejected.\n");
+        ++num_of_failed;
+    }
+    return num_of_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include "Newton_opt.h"
+#include "Random_search.h"
+#include "Test_functions.h"
+#include <iostream>
+#include <cstdio>
+
+/**
+ * @brief Checks that two methods went through the same iterates.
+ * @param expected Method that ran without interruption.
+ * @param actual Method that was resumed from a checkpoint.
+ * @return True if the sequences of points and values are identical, false otherwise.
+ */
+static bool is_same_run(Optimization_method& expected, Optimization_method& actual) {
+    return expected.get_num_of_iter() == actual.get_num_of_iter() &&
+        expected.get_seq_x_i() == actual.get_seq_x_i() &&
+        expected.get_seq_f_i() == actual.get_seq_f_i();
+}
+
+/**
+ * @brief Stops Newton's method after a few iterations and resumes it in a new object.
+ * @return True if the resumed run matches the uninterrupted one, false otherwise.
+ */
+static bool test_newton_resume() {
+    Area area({ {-5, 5}, {-5, 5} });
+    Newton_opt uninterrupted(new Function3(2), { -1.2, 1 }, area, new Criterion_grad_f(1e-6, 200));
+    uninterrupted.optimization();
+
+    {
+        Newton_opt interrupted(new Function3(2), { -1.2, 1 }, area, new Criterion_grad_f(1e-6, 5));
+        interrupted.set_checkpoint("newton.ckpt", 2);
+        interrupted.optimization();
+    }
+    Newton_opt resumed(new Function3(2), { 0, 0 }, area, new Criterion_grad_f(1e-6, 200));
+    resumed.resume("newton.ckpt");
+    resumed.optimization();
+    return uninterrupted.get_num_of_iter() > 5 && is_same_run(uninterrupted, resumed);
+}
+
+/**
+ * @brief Continues a random search from one checkpoint twice, once with a stop and a second checkpoint on the way.
+ * The seed comes from the clock, so both continuations start from the same checkpoint.
+ * @return True if the run with the stop matches the run without it, false otherwise.
+ */
+static bool test_random_search_resume() {
+    Area area({ {-2, 2}, {-2, 2} });
+    {
+        Random_search start(new Quadratic_function(2, 10), { 1.5, 1.5 }, area, new Criterion_max_iter(1000), 0.5, 1, 0.9);
+        start.set_checkpoint("random_start.ckpt", 300);
+        start.optimization();
+    }
+
+    Random_search uninterrupted(new Quadratic_function(2, 10), { 1.5, 1.5 }, area, new Criterion_max_iter(3000), 0.5, 1, 0.9);
+    uninterrupted.resume("random_start.ckpt");
+    uninterrupted.optimization();
+
+    {
+        Random_search interrupted(new Quadratic_function(2, 10), { 1.5, 1.5 }, area, new Criterion_max_iter(2000), 0.5, 1, 0.9);
+        interrupted.resume("random_start.ckpt");
+        interrupted.set_checkpoint("random_stop.ckpt", 300);
+        interrupted.optimization();
+    }
+    Random_search resumed(new Quadratic_function(2, 10), { 1.5, 1.5 }, area, new Criterion_max_iter(3000), 0.5, 1, 0.9);
+    resumed.resume("random_stop.ckpt");
+    resumed.optimization();
+    return uninterrupted.get_seq_f_i().size() > 2 && is_same_run(uninterrupted, resumed);
+}
+
+int main() {
+    int num_of_failed = 0;
+    if (!test_newton_resume()) {
+        std::cerr << "Resumed Newton's method differs from the uninterrupted run." << std::endl;
+        ++num_of_failed;
+    }
+    if (!test_random_search_resume()) {
+        std::cerr << "Resumed random search differs from the uninterrupted run." << std::endl;
+        ++num_of_failed;
+    }
+    for (const char* path : { "newton.ckpt", "random_start.ckpt", "random_stop.ckpt" }) {
+        std::remove(path);
+        std::remove(Checkpoint::history_path(path).c_str());
+    }
+    return num_of_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include "Trajectory.h"
+#include "Newton_opt.h"
+#include <iostream>
+#include <cstdio>
+
+/**
+ * @brief Writes records with a partial last block and reads them back through the mapping.
+ * @param is_background True to write the blocks by the background thread.
+ * @return True if every field of every record is read back unchanged, false otherwise.
+ */
+static bool test_round_trip(bool is_background) {
+    const int dim = 3;
+    const size_t num_of_records = 2500;
+    {
+        Trajectory_writer writer("round_trip.traj", dim, 1000, is_background);
+        for (size_t k = 0; k < num_of_records; ++k) {
+            double x[dim] = { 0.5 * k, -1.0 * k, 1.0 / (k + 1) };
+            writer.record(x, 0.25 * k, static_cast<int64_t>(k / 3), k % 3 == 0);
+        }
+    }
+
+    Trajectory_reader reader("round_trip.traj");
+    if (reader.get_dim() != dim || reader.get_size() != num_of_records || reader.get_num_of_blocks() != 3)
+        return false;
+    for (size_t k = 0; k < num_of_records; ++k) {
+        if (reader.get_f(k) != 0.25 * k || reader.get_iter(k) != static_cast<int64_t>(k / 3) || reader.is_accepted(k) != (k % 3 == 0) ||
+            reader.get_x(k, 0) != 0.5 * k || reader.get_x(k, 1) != -1.0 * k || reader.get_x(k, 2) != 1.0 / (k + 1))
+            return false;
+    }
+    const Trajectory_block& last = reader.get_block(2);
+    return last.size == 500 && last.f[499] == 0.25 * (num_of_records - 1);
+}
+
+/**
+ * @brief Records a run of Newton's method and compares the accepted points with its iterates.
+ * @return True if the accepted records are exactly the sequence of iterates, false otherwise.
+ */
+static bool test_optimization_trajectory() {
+    Newton_opt method(new Function3(2), { -1.2, 1 }, Area({ {-5, 5}, {-5, 5} }), new Criterion_grad_f(1e-6, 200));
+    {
+        Trajectory_writer writer("newton.traj", 2, 8);
+        method.set_trajectory(&writer);
+        method.optimization();
+        method.set_trajectory(nullptr);
+    }
+
+    Trajectory_reader reader("newton.traj");
+    std::vector<std::vector<double>> seq_x_i = method.get_seq_x_i();
+    std::vector<double> seq_f_i = method.get_seq_f_i();
+    size_t num_of_accepted = 0;
+    for (size_t k = 0; k < reader.get_size(); ++k) {
+        if (!reader.is_accepted(k))
+            continue;
+        if (num_of_accepted >= seq_f_i.size() || reader.get_f(k) != seq_f_i[num_of_accepted] ||
+            reader.get_x(k, 0) != seq_x_i[num_of_accepted][0] || reader.get_x(k, 1) != seq_x_i[num_of_accepted][1])
+            return false;
+        ++num_of_accepted;
+    }
+    return num_of_accepted == seq_f_i.size();
+}
+
+int main() {
+    int num_of_failed = 0;
+    if (!test_round_trip(false)) {
+        std::cerr << "Trajectory written directly is not read back unchanged." << std::endl;
+        ++num_of_failed;
+    }
+    if (!test_round_trip(true)) {
+        std::cerr << "Trajectory written by the background thread is not read back unchanged." << std::endl;
+        ++num_of_failed;
+    }
+    if (!test_optimization_trajectory()) {
+        std::cerr << "Accepted trajectory records differ from the iterates of Newton's method." << std::endl;
+        ++num_of_failed;
+    }
+    std::remove("round_trip.traj");
+    std::remove("newton.traj");
+    return num_of_failed == 0 ? 0 : 1;
+}